@@ -13,6 +13,7 @@
 #include "octotiger/options.hpp"
 #include "octotiger/physcon.hpp"
 #include "octotiger/problem.hpp"
+#include "octotiger/scratch_arena.hpp"
 #include "octotiger/test_problems/rotating_star.hpp"
 #include "octotiger/test_problems/blast.hpp"
 #include "octotiger/unitiger/physics.hpp"
@@ -41,6 +42,7 @@
 
 #include <chrono>
 #include <cstdio>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -89,6 +91,10 @@ std::size_t init_thread_local_worker(std::size_t desired)
         multi_inter_p2p::inner_stencil_masks() =
             multi_inter::calculate_stencil_masks(multi_inter_p2p::stencil())
                 .second;
+
+        // Size and first-touch this worker's scratch arena
+        octotiger::scratch_arena::local().reserve(opts().scratch_size << 20);
+
         // print run informations
         if (current ==0) {
         std::cout << "\nSubgrid side-length is " << INX << std::endl;
@@ -173,47 +179,47 @@ void initialize(options _opts, std::vector<hpx::id_type> const& localities) {
 	} else if (opts().problem == DWD) {
 		opts().n_species=5;
 		set_problem(scf_binary);
-		set_refine_test(refine_test);
+		set_refine_test(refine_test, refine_pencil_test);
 	} else if (opts().problem == SOD) {
 		grid::set_fgamma(7.0 / 5.0);
 //		opts().gravity = false;
 		set_problem(sod_shock_tube_init);
-		set_refine_test(refine_sod);
+		set_refine_test(refine_sod, refine_pencil_sod);
 		set_analytic(sod_shock_tube_analytic);
 #if defined(OCTOTIGER_HAVE_BLAST_TEST)
 	} else if (opts().problem == BLAST) {
 		grid::set_fgamma(7.0 / 5.0);
 //		opts().gravity = false;
 		set_problem(blast_wave);
-		set_refine_test(refine_blast);
+		set_refine_test(refine_blast, refine_pencil_blast);
 		set_analytic(blast_wave_analytic);
 #endif
 	} else if (opts().problem == STAR) {
 		grid::set_fgamma(5.0 / 3.0);
 		set_problem(star);
-		set_refine_test(refine_test_moving_star);
+		set_refine_test(refine_test_moving_star, refine_pencil_test_moving_star);
 	} else if (opts().problem == ROTATING_STAR) {
 		grid::set_fgamma(5.0 / 3.0);
 		set_problem(rotating_star);
 		set_analytic(rotating_star_a);
-		set_refine_test(refine_test_moving_star);
+		set_refine_test(refine_test_moving_star, refine_pencil_test_moving_star);
 	} else if (opts().problem == MOVING_STAR) {
 		grid::set_fgamma(5.0 / 3.0);
 //		grid::set_analytic_func(moving_star_analytic);
 		set_problem(moving_star);
-		set_refine_test(refine_test_moving_star);
+		set_refine_test(refine_test_moving_star, refine_pencil_test_moving_star);
 	} else if (opts().problem == AMR_TEST) {
 		grid::set_fgamma(5.0 / 3.0);
 //		grid::set_analytic_func(moving_star_analytic);
 		set_problem(amr_test);
-		set_refine_test(refine_test_moving_star);
+		set_refine_test(refine_test_moving_star, refine_pencil_test_moving_star);
 		set_refine_test(refine_test_amr);
 	} else if (opts().problem == MARSHAK) {
 		grid::set_fgamma(5.0 / 3.0);
 		set_analytic(nullptr);
 		set_analytic(marshak_wave_analytic);
 		set_problem(marshak_wave);
-		set_refine_test(refine_test_marshak);
+		set_refine_test(refine_test_marshak, refine_pencil_test_level);
 	} else if (opts().problem == SOLID_SPHERE) {
 	//	opts().hydro = false;
 		set_analytic([](real x, real y, real z, real dx) {
@@ -339,6 +345,10 @@ std::array<size_t, 6> analyze_local_launch_counters() {
             (static_cast<float>(total_p2p_cuda_launches) + total_p2p_cpu_launches);
         std::cout << "=> Percentage of p2p on the GPU on locality " << hpx::get_locality_id() << ": " << percentage * 100 << "\n";
     }
+    std::cout << "----------------------------------------" << std::endl;
+    std::cout << "Scratch arena high water mark on locality " << hpx::get_locality_id() << ": "
+              << octotiger::scratch_arena::high_water_mark() << " of " << (opts().scratch_size << 20) << " bytes ("
+              << octotiger::scratch_arena::overflow_count() << " heap fallbacks)" << std::endl;
     return results;
 }
 HPX_PLAIN_ACTION(analyze_local_launch_counters, analyze_local_launch_counters_action);
@@ -533,7 +543,51 @@ int hpx_main(int argc, char* argv[]) {
 	return hpx::finalize();
 }
 
+/* Hands the run over to octotiger-grid<N> next to this binary if --griddim asks for another sub-grid size */
+int exec_griddim(int argc, char* argv[]) {
+	int griddim = INX;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		std::string value;
+		if (arg.compare(0, 10, "--griddim=") == 0) {
+			value = arg.substr(10);
+		} else if (arg == "--griddim" && i + 1 < argc) {
+			value = argv[i + 1];
+		} else {
+			continue;
+		}
+		try {
+			griddim = std::stoi(value);
+		} catch (const std::exception&) {
+			printf("Invalid value %s for --griddim\n", value.c_str());
+			return -1;
+		}
+	}
+	if (griddim == INX) {
+		return 0;
+	}
+#if !defined(_MSC_VER)
+	/* the sibling binary lives next to this one, argv[0] does not say where when started through PATH */
+	std::string path = argv[0];
+	char exe[4096];
+	const auto len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+	if (len > 0) {
+		path.assign(exe, len);
+	}
+	const auto slash = path.find_last_of('/');
+	path = (slash == std::string::npos ? std::string("./") : path.substr(0, slash + 1)) + "octotiger-grid" + std::to_string(griddim);
+	if (access(path.c_str(), X_OK) == 0) {
+		execv(path.c_str(), argv);
+	}
+	printf("Unable to run %s for --griddim=%i\n", path.c_str(), griddim);
+#endif
+	return -1;
+}
+
 int main(int argc, char* argv[]) {
+	if (exec_griddim(argc, argv) != 0) {
+		return 1;
+	}
 	std::vector<std::string> cfg = { "hpx.commandline.allow_unknown=1", // HPX should not complain about unknown command line options
 			"hpx.scheduler=local-priority-lifo",       // Use LIFO scheduler by default
 			"hpx.parcel.mpi.zero_copy_optimization!=0" // Disable the usage of zero copy optimization for MPI...
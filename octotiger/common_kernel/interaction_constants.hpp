@@ -53,6 +53,12 @@ namespace fmm {
 
     constexpr uint64_t ENTRIES = PADDED_STRIDE * PADDED_STRIDE * PADDED_STRIDE;
 
+    // the root sub-grid interacts with all of its own cells but has no neighbors: x and y are
+    // stored unpadded, z is padded with INX zero cells on both sides for the SIMD loads
+    constexpr uint64_t ROOT_PADDED_STRIDE = 3 * INNER_CELLS_PER_DIRECTION;
+    constexpr uint64_t ROOT_ENTRIES =
+        INNER_CELLS_PER_DIRECTION * INNER_CELLS_PER_DIRECTION * ROOT_PADDED_STRIDE;
+
     constexpr uint64_t EXPANSION_COUNT_PADDED = detail::const_pow(PADDED_STRIDE, DIMENSION);
     constexpr uint64_t EXPANSION_COUNT_NOT_PADDED = INNER_CELLS;
 
@@ -108,6 +108,13 @@ namespace fmm {
       PADDED_STRIDE + (m.z - PADDING_OFFSET);
     }
 
+    /// flat index into the root sub-grid layout (see ROOT_PADDED_STRIDE), m is unpadded
+    template <typename T>
+    CUDA_CALLABLE_METHOD inline T to_root_flat_index_padded(const multiindex<T>& m) {
+        return (m.x * INNER_CELLS_PER_DIRECTION + m.y) * ROOT_PADDED_STRIDE + m.z +
+            INNER_CELLS_PER_DIRECTION;
+    }
+
     /** are only valid for single cell! (no padding)
      * Note: for m2m_int_vector and integer
      * Note: returns uint32_t vector because of Vc limitation */
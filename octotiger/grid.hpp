@@ -13,6 +13,7 @@
 #include "octotiger/defs.hpp"
 #include "octotiger/diagnostics.hpp"
 #include "octotiger/geometry.hpp"
+#include "octotiger/insitu.hpp"
 #include "octotiger/interaction_types.hpp"
 #include "octotiger/problem.hpp"
 #include "octotiger/radiation/rad_grid.hpp"
@@ -137,7 +138,12 @@ private:
 	std::vector<roche_type> roche_lobe;
 	std::vector<std::atomic<int>> is_coarse;
 	std::vector<std::atomic<int>> has_coarse;
+	/* the directions set_hydro_amr_boundary was called for since clear_amr */
+	std::vector<std::atomic<int>> amr_dirs;
 	std::vector<std::vector<real>> Ushad;
+	/* the cells of is_coarse, built for the AMR directions amr_coarse_dirs */
+	std::vector<int> amr_coarse_list;
+	integer amr_coarse_dirs = -1;
 	std::vector<std::vector<safe_real>> U;
 	std::vector<std::vector<safe_real>> U0;
 	std::vector<std::vector<safe_real>> dUdt;
@@ -149,6 +155,11 @@ private:
 	std::vector<expansion> L;
 	std::vector<space_vector> L_c;
 	std::vector<real> dphi_dt;
+	// lazy FMM (fmm_tolerance > 0), per gsolve_type: cell source masses of the last forced
+	// full solve and the interaction part of L, L_c of the last evaluation
+	std::array<std::vector<real>, 2> fmm_source_ref;
+	std::array<std::vector<expansion>, 2> fmm_L_cache;
+	std::array<std::vector<space_vector>, 2> fmm_L_c_cache;
 #ifdef OCTOTIGER_HAVE_GRAV_PAR
 	std::unique_ptr<hpx::lcos::local::spinlock> L_mtx;
 #endif
@@ -162,6 +173,10 @@ private:
 	std::vector<real> U_out0;
 	std::vector<std::shared_ptr<std::vector<space_vector>>> com_ptr;
 	static bool xpoint_eq(const xpoint& a, const xpoint& b);
+	void update_outflows(integer rk, real dt);
+	std::vector<real> pack_hydro() const;
+	void unpack_hydro(const std::vector<real>&);
+	void enforce_floors(integer i, integer j, integer k);
 	void compute_boundary_interactions_multipole_multipole(gsolve_type type, const std::vector<boundary_interaction_type>&,
 			const gravity_boundary_type&);
 	void compute_boundary_interactions_monopole_monopole(gsolve_type type, const std::vector<boundary_interaction_type>&,
@@ -177,6 +192,8 @@ public:
 	std::vector<roche_type> get_roche_lobe() const;
 	void rho_from_species();
 	static bool is_hydro_field(const std::string&);
+	/* -1 unless str is a hydro field */
+	static int hydro_field_index(const std::string& str);
 	static std::vector<std::string> get_field_names();
 	static std::vector<std::string> get_hydro_field_names();
 
@@ -240,6 +257,7 @@ public:
 		scaling_factor = f;
 	}
 	diagnostics_t diagnostics(const diagnostics_t& diags);
+	void insitu(insitu_t& rc) const;
 	static real get_scaling_factor() {
 		return scaling_factor;
 	}
@@ -307,6 +325,10 @@ public:
 	void dual_energy_update();
 	void solve_gravity(gsolve_type = RHO);
 	multipole_pass_type compute_multipoles(gsolve_type, const multipole_pass_type* = nullptr);
+	bool fmm_source_changed(gsolve_type, bool full_solve);
+	void store_fmm_interactions(gsolve_type);
+	bool restore_fmm_interactions(gsolve_type);
+	void clear_fmm_cache();
 	void compute_interactions(gsolve_type);
 	void rho_mult(real f0, real f1);
 	void rho_move(real x);
@@ -349,10 +371,19 @@ public:
 	void allocate();
 	void store();
 	void restore();
+	/* move the persistent arrays to storage first touched by the calling worker */
+	void rehome();
 	real compute_fluxes();
 	void compute_sources(real t, real);
 	void set_physical_boundaries(const geo::face&, real t);
 	void next_u(integer rk, real t, real dt);
+	/* --rk_stage=FUSED: compute_drho_dt feeds the DRHODT solve, next_u_fused then does the work of
+	 * compute_sources, compute_dudt and next_u in one sweep over the interior */
+	void compute_drho_dt();
+	void next_u_fused(integer rk, real t, real rotational_time, real dt);
+	/* --rk_stage=VERIFY: after compute_sources and compute_dudt, apply both next_u and next_u_fused to
+	 * the same state, report values that differ bitwise and keep the next_u result */
+	void verify_next_u_fused(integer rk, real t, real rotational_time, real dt);
 	template<class Archive>
 	void load(Archive& arc, const unsigned);
 	static real convert_gravity_units(int);
@@ -390,6 +421,10 @@ struct is_bitwise_serializable<grid::node_point> : std::true_type {
 
 void scf_binary_init();
 
+/* Only the persistent state travels when a grid migrates: U with its ghost zones, the radiation fields and
+ * the outflows.  The ghost zones go along because regrid_scatter prolongs new children from them before the
+ * next boundary exchange.  X is rebuilt by allocate(), G and the multipoles by the gravity solve that ends
+ * every regrid. */
 template<class Archive>
 void grid::load(Archive& arc, const unsigned) {
 	arc >> roche_lobe;
@@ -398,21 +433,13 @@ void grid::load(Archive& arc, const unsigned) {
 	arc >> dx;
 	arc >> xmin;
 	allocate();
-	arc >> U;
+	std::vector<real> hydro;
+	arc >> hydro;
+	unpack_hydro(hydro);
 	if (rad_grid_ptr != nullptr) {
 		arc >> *rad_grid_ptr;
 		rad_grid_ptr->set_dx(dx);
 	}
-	for (integer i = 0; i != INX * INX * INX; ++i) {
-#if defined(HPX_HAVE_DATAPAR)
-		arc >> G[i];
-#else
-		arc >> G[i][0];
-		arc >> G[i][1];
-		arc >> G[i][2];
-		arc >> G[i][3];
-#endif
-	}
 	arc >> U_out;
 }
 
@@ -423,20 +450,11 @@ void grid::save(Archive& arc, const unsigned) const {
 	arc << is_root;
 	arc << dx;
 	arc << xmin;
-	arc << U;
+	/* one contiguous array, large enough for HPX to send it as a zero copy chunk */
+	arc << pack_hydro();
 	if (rad_grid_ptr != nullptr) {
 		arc << *rad_grid_ptr;
 	}
-	for (integer i = 0; i != INX * INX * INX; ++i) {
-#if defined(HPX_HAVE_DATAPAR)
-		arc << G[i];
-#else
-		arc << G[i][0];
-		arc << G[i][1];
-		arc << G[i][2];
-		arc << G[i][3];
-#endif
-	}
 	arc << U_out;
 }
 
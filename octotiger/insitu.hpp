@@ -0,0 +1,70 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef INSITU_HPP_
+#define INSITU_HPP_
+
+#include "octotiger/defs.hpp"
+#include "octotiger/real.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+/* Reduced output computed during the run (--insitu), a few small products written every --insitu_dt orbits
+ * instead of a full SILO dump.  The root sets up the request from the options, every leaf deposits into it
+ * and the partial results are summed, first per locality and then at the root.
+ *
+ * Images cover the whole domain with insitu_resolution^2 pixels.  A leaf cell adds to every pixel it overlaps
+ * in proportion to the overlap area, so the sum over all leaves is the area average at any refinement level.
+ *   projection_<d>  column density of rho along axis d
+ *   slice_<d>       the insitu_fields in the plane d = 0 (slice_z is equatorial, slice_x and slice_y meridional)
+ *   profile         shell mass and volume averaged insitu_fields in spherical radius about the origin
+ */
+struct insitu_t {
+	/* the request */
+	integer resolution = 0;
+	real xmax = 0.0;
+	std::array<bool, NDIM> projection = { { false, false, false } };
+	std::array<bool, NDIM> slice = { { false, false, false } };
+	bool profile = false;
+	std::vector<integer> fields;
+	std::vector<std::string> field_names;
+
+	/* the results, images are stored row by row with the second image axis running fastest */
+	std::array<std::vector<real>, NDIM> projection_data;
+	/* one image per field, one after the other */
+	std::array<std::vector<real>, NDIM> slice_data;
+	/* per radial bin: volume, mass, then the integral of every field */
+	std::vector<real> profile_data;
+
+	/* empty (nothing to do) unless --insitu selects a product */
+	static insitu_t from_options();
+	bool empty() const;
+	/* a request like this one with zeroed results */
+	insitu_t zeroed() const;
+	integer profile_bins() const {
+		return resolution / 2;
+	}
+	insitu_t& operator+=(const insitu_t&);
+	/* one text file per product, <data_dir>insitu.<cnt>.<product>.dat */
+	void write(integer cnt, real t) const;
+
+	template<class Arc>
+	void serialize(Arc &arc, const unsigned) {
+		arc & resolution;
+		arc & xmax;
+		arc & projection;
+		arc & slice;
+		arc & profile;
+		arc & fields;
+		arc & field_names;
+		arc & projection_data;
+		arc & slice_data;
+		arc & profile_data;
+	}
+};
+
+#endif /* INSITU_HPP_ */
@@ -10,6 +10,8 @@
 #include "octotiger/space_vector.hpp"
 #include "octotiger/taylor.hpp"
 
+#include <hpx/serialization/serialize.hpp>
+#include <hpx/serialization/vector.hpp>
 #include <hpx/synchronization/counting_semaphore.hpp>
 
 #include <Vc/Vc>
@@ -29,10 +31,16 @@ struct gravity_boundary_type
     std::shared_ptr<std::vector<real>> m;
     std::shared_ptr<std::vector<space_vector>> x;
     semaphore* local_semaphore;
+    /// false if the sender's sources did not change beyond fmm_tolerance since the last full solve
+    bool changed;
+    /// send the multipoles in single precision (monopoles and centers of mass stay double)
+    bool reduced_precision;
     gravity_boundary_type()
       : M(nullptr)
       , m(nullptr)
-      , x(nullptr) {}
+      , x(nullptr)
+      , changed(true)
+      , reduced_precision(false) {}
     void allocate() {
         local_semaphore = nullptr;
         if (M == nullptr) {
@@ -42,15 +50,53 @@ struct gravity_boundary_type
         }
     }
     template <class Archive>
-    void serialize(Archive& arc, unsigned) {
+    void load(Archive& arc, unsigned) {
         allocate();
-        std::uintptr_t tmp = reinterpret_cast<std::uintptr_t>(local_semaphore);
-        arc& M;
-        arc& m;
-        arc& x;
-        arc& tmp;
+        std::uintptr_t tmp;
+        arc >> reduced_precision;
+        if (reduced_precision) {
+            std::vector<float> packed;
+            arc >> packed;
+            M->resize(packed.size() / taylor_sizes[3]);
+            for (std::size_t i = 0; i != M->size(); ++i) {
+                for (integer j = 0; j != taylor_sizes[3]; ++j) {
+                    (*M)[i][j] = packed[i * taylor_sizes[3] + j];
+                }
+            }
+        } else {
+            arc >> *M;
+        }
+        arc >> *m;
+        arc >> *x;
+        arc >> tmp;
+        arc >> changed;
         local_semaphore = reinterpret_cast<decltype(local_semaphore)>(tmp);
     }
+    template <class Archive>
+    void save(Archive& arc, unsigned) const {
+        const std::vector<multipole> no_M;
+        const std::vector<real> no_m;
+        const std::vector<space_vector> no_x;
+        const std::vector<multipole>& M_ref = M ? *M : no_M;
+        std::uintptr_t tmp = reinterpret_cast<std::uintptr_t>(local_semaphore);
+        arc << reduced_precision;
+        if (reduced_precision) {
+            std::vector<float> packed(M_ref.size() * taylor_sizes[3]);
+            for (std::size_t i = 0; i != M_ref.size(); ++i) {
+                for (integer j = 0; j != taylor_sizes[3]; ++j) {
+                    packed[i * taylor_sizes[3] + j] = static_cast<float>(M_ref[i][j]);
+                }
+            }
+            arc << packed;
+        } else {
+            arc << M_ref;
+        }
+        arc << (m ? *m : no_m);
+        arc << (x ? *x : no_x);
+        arc << tmp;
+        arc << changed;
+    }
+    HPX_SERIALIZATION_SPLIT_MEMBER();
 };
 Vc_DECLARE_ALLOCATOR(gravity_boundary_type)
 
@@ -24,6 +24,21 @@ namespace fmm {
     namespace monopole_interactions {
 
         constexpr uint64_t P2P_STENCIL_BLOCKING = 24;
+
+        /// One stencil element that interacts with at least one lane of a SIMD group.
+        /// Which lanes interact only depends on the parity of the target cell on the
+        /// coarse level, so the lists are built once per parity class and reused for
+        /// every target cell and every leaf sub-grid.
+        struct p2p_stencil_entry
+        {
+            /// flat offset of the interaction partner in the padded monopole array
+            int32_t partner_offset;
+            /// index into the full stencil (four constants)
+            int32_t stencil_index;
+            /// per row (i1, i1 + 1): bit p is set if lanes with z-parity p interact
+            uint8_t lanes[2];
+        };
+
         class p2p_cpu_kernel
         {
         private:
@@ -35,18 +50,14 @@ namespace fmm {
             const m2m_vector theta_rec_squared;
             m2m_int_vector offset_vector;
 
-            void cell_interactions(
-                std::vector<real>& mons,
+            void cell_interactions(const std::vector<real>& mons,
                 struct_of_array_data<expansion, real, 20, INNER_CELLS,
                     SOA_PADDING>& __restrict__ potential_expansions_SoA,    // L
-                const multiindex<>& __restrict__ cell_index,
                 const size_t cell_flat_index,    /// iii0
-                const multiindex<m2m_int_vector>& __restrict__ cell_index_coarse,
-                const multiindex<>& __restrict__ cell_index_unpadded,
                 const size_t cell_flat_index_unpadded,
-                const std::vector<bool>& __restrict__ stencil,
-                const std::vector<std::array<real, 4>>& __restrict__ four_constants,
-                const size_t outer_stencil_index, real dx);
+                const std::vector<p2p_stencil_entry>& interaction_list,
+                const m2m_vector (&lane_patterns)[4],
+                const std::vector<std::array<real, 4>>& __restrict__ four_constants, real dx);
 
         public:
             p2p_cpu_kernel(std::vector<bool>& neighbor_empty);
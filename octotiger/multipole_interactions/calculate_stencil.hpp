@@ -13,5 +13,7 @@ namespace octotiger { namespace fmm { namespace multipole_interactions {
     OCTOTIGER_EXPORT two_phase_stencil calculate_stencil();
     OCTOTIGER_EXPORT std::pair<std::vector<bool>, std::vector<bool>>
     calculate_stencil_masks(two_phase_stencil superimposed_stencil);
+    /// All offsets within the root sub-grid that are well separated on the root level
+    OCTOTIGER_EXPORT std::vector<multiindex<>> calculate_root_stencil();
 
 }}}
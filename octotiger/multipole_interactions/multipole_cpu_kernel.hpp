@@ -119,6 +119,18 @@ namespace fmm {
                     angular_corrections_SoA,
                 const std::vector<real>& mons, const std::vector<bool> &stencil, const std::vector<bool>&
                 inner_stencil, gsolve_type type);
+
+            /// Calculate the interactions of the root sub-grid with itself. The root has
+            /// neither neighbors nor a parent, so it uses its own stencil and data layout
+            void apply_root_stencil(const struct_of_array_data<expansion, real, 20,
+                                        ROOT_ENTRIES, SOA_PADDING>& root_expansions_SoA,
+                const struct_of_array_data<space_vector, real, 3, ROOT_ENTRIES, SOA_PADDING>&
+                    root_center_of_masses_SoA,
+                struct_of_array_data<expansion, real, 20, INNER_CELLS, SOA_PADDING>&
+                    potential_expansions_SoA,
+                struct_of_array_data<space_vector, real, 3, INNER_CELLS, SOA_PADDING>&
+                    angular_corrections_SoA,
+                const std::vector<multiindex<>>& root_stencil, gsolve_type type);
         };
 
     }    // namespace multipole_interactions
@@ -64,6 +64,9 @@ namespace fmm {
                     local_expansions_SoA,
                 const struct_of_array_data<space_vector, real, 3, ENTRIES, SOA_PADDING>&
                     center_of_masses_SoA);
+            /// Interactions of the root sub-grid with itself (no neighbors, no parent)
+            void compute_root_interactions(std::vector<multipole>& M_ptr,
+                std::vector<std::shared_ptr<std::vector<space_vector>>>& com_ptr);
 
         protected:
             gsolve_type type;
@@ -89,6 +92,7 @@ namespace fmm {
             static OCTOTIGER_EXPORT two_phase_stencil& stencil();
             static OCTOTIGER_EXPORT std::vector<bool>& stencil_masks();
             static OCTOTIGER_EXPORT std::vector<bool>& inner_stencil_masks();
+            static OCTOTIGER_EXPORT std::vector<multiindex<>>& root_stencil();
         };
 
         template <typename monopole_container, typename expansion_soa_container,
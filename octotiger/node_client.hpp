@@ -84,7 +84,6 @@ public:
         const geo::octant& ci) const;
     void send_rad_flux_correct(std::vector<real>&&, const geo::face& face,
         const geo::octant& ci) const;
-    future<diagnostics_t> diagnostics(const diagnostics_t&) const;
     future<analytic_t> compare_analytic() const;
     //	hpx::future<void> set_parent(hpx::id_type);
     node_client();
@@ -13,6 +13,9 @@
 //#include <hpx/serialization/traits/is_bitwise_serializable.hpp>
 
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <utility>
 
 class node_client;
 
@@ -20,35 +23,134 @@ using range_type = std::array<std::pair<int, int>, NDIM>;
 
 range_type intersection(const range_type& r1, const range_type& r2);
 
+/* A node of the octree, stored as one 64 bit Morton key: a sentinel bit at 3 * level followed by the
+ * interleaved coordinates, coarsest level on top, with x in the lowest bit of every triple.  The key
+ * of a child is key << 3 | child index, so parent, child and level are shifts, and the keys of all
+ * descendants of a node at a given level form one contiguous range.  Keys compare by level first, then
+ * along the Z-order curve.  The Silo node list uses a different id with the levels in reverse order,
+ * to_id / from_id convert to and from it.
+ */
 class node_location {
-private:
-	std::array<integer, NDIM> xloc;
-	integer lev;
 public:
 	using node_id = std::uint64_t;
+	static constexpr integer max_level = 21;
+private:
+	node_id key;
+
+	static node_id spread(node_id x) {
+		x &= 0x1fffff;
+		x = (x | x << 32) & 0x1f00000000ffffULL;
+		x = (x | x << 16) & 0x1f0000ff0000ffULL;
+		x = (x | x << 8) & 0x100f00f00f00f00fULL;
+		x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+		x = (x | x << 2) & 0x1249249249249249ULL;
+		return x;
+	}
+	static node_id compact(node_id x) {
+		x &= 0x1249249249249249ULL;
+		x = (x ^ (x >> 2)) & 0x10c30c30c30c30c3ULL;
+		x = (x ^ (x >> 4)) & 0x100f00f00f00f00fULL;
+		x = (x ^ (x >> 8)) & 0x1f0000ff0000ffULL;
+		x = (x ^ (x >> 16)) & 0x1f00000000ffffULL;
+		x = (x ^ (x >> 32)) & 0x1fffff;
+		return x;
+	}
+	static integer level_of(node_id k) {
+#if defined(__GNUC__)
+		return (63 - __builtin_clzll(k)) / NDIM;
+#else
+		integer l = 0;
+		while (k >>= NDIM) {
+			++l;
+		}
+		return l;
+#endif
+	}
+	static node_id encode(integer lev, const std::array<integer, NDIM>& x) {
+		return (node_id(1) << (NDIM * lev)) | spread(x[XDIM]) | (spread(x[YDIM]) << 1) | (spread(x[ZDIM]) << 2);
+	}
+	std::array<integer, NDIM> coordinates() const {
+		const node_id body = key ^ (node_id(1) << (NDIM * level()));
+		return { { integer(compact(body)), integer(compact(body >> 1)), integer(compact(body >> 2)) } };
+	}
+public:
 	node_id to_id() const;
 	void from_id(const node_id&);
-	node_location();
-	node_location(const node_location& other);
+	node_location() :
+			key(1) {
+	}
+	node_location(const node_location& other) = default;
 	node_location(node_location::node_id id);
-	node_location& operator=(const node_location& other);
-	integer level() const;
-	node_location get_child(integer x, integer y, integer z) const;
-	node_location get_child(integer c) const;
-	node_location get_parent() const;
+	node_location& operator=(const node_location& other) = default;
+	static node_location from_key(node_id k) {
+		node_location loc;
+		loc.key = k;
+		return loc;
+	}
+	/* the Morton key, see above */
+	node_id morton_key() const {
+		return key;
+	}
+	/* [first, last] of the keys of all descendants at level lev >= level(), the key followed by any low bits */
+	std::pair<node_id, node_id> descendant_range(integer lev) const {
+		const integer shift = NDIM * (lev - level());
+		const node_id first = key << shift;
+		return {first, first | ((node_id(1) << shift) - 1)};
+	}
+	integer level() const {
+		return level_of(key);
+	}
+	/* pre-order of the tree with the children in child index order, ancestors before their descendants.
+	 * This is the space filling curve regrid_scatter distributes the nodes along. */
+	bool sfc_less(const node_location& other) const {
+		const integer l = level();
+		const integer lo = other.level();
+		if (l <= lo) {
+			/* other follows us if it is one of our descendants or lies after all of them */
+			return key != other.key && descendant_range(lo).first <= other.key;
+		}
+		return key < other.descendant_range(l).first;
+	}
+	node_location get_child(integer x, integer y, integer z) const {
+		return from_key((key << NDIM) | node_id(x | (y << 1) | (z << 2)));
+	}
+	node_location get_child(integer c) const {
+		return from_key((key << NDIM) | node_id(c));
+	}
+	node_location get_parent() const {
+		assert(level() >= 1);
+		return from_key(key >> NDIM);
+	}
 	node_location get_sibling(integer face) const;
-	geo::side get_child_side(const geo::dimension&) const;
+	geo::side get_child_side(const geo::dimension& d) const {
+		return ((key >> integer(d)) & 1) ? geo::PLUS : geo::MINUS;
+	}
 	geo::octant get_child_index() const;
 	integer operator[](integer i) const {
-		return xloc[i];
-	}
-	std::size_t hash() const;
-	bool operator==(const node_location& other) const;
-	bool operator!=(const node_location& other) const;
-	bool operator<(const node_location& other) const;
-	bool operator >=(const node_location& other) const;
-	bool operator >(const node_location& other) const;
-	bool operator <=(const node_location& other) const;
+		const node_id body = key ^ (node_id(1) << (NDIM * level()));
+		return integer(compact(body >> i));
+	}
+	std::size_t hash() const {
+		return std::size_t(key);
+	}
+	bool operator==(const node_location& other) const {
+		return key == other.key;
+	}
+	bool operator!=(const node_location& other) const {
+		return key != other.key;
+	}
+	bool operator<(const node_location& other) const {
+		return key < other.key;
+	}
+	bool operator >=(const node_location& other) const {
+		return key >= other.key;
+	}
+	bool operator >(const node_location& other) const {
+		return key > other.key;
+	}
+	bool operator <=(const node_location& other) const {
+		return key <= other.key;
+	}
 	std::size_t unique_id() const;
 	hpx::future<void> register_client(const node_client& client) const;
 //	hpx::future<hpx::id_type> get_id() const;
@@ -58,13 +160,13 @@ public:
 	std::string to_str() const;
 	template<class Archive>
 	void serialize(Archive& arc, unsigned) {
-		arc & lev;
-		arc & xloc;
+		arc & key;
 	}
 	std::size_t load(FILE* fp);
 	std::size_t save(FILE* fp) const;
 	std::vector<node_location> get_neighbors() const;
 	bool has_neighbor(const geo::direction dir) const;
+	/* requires has_neighbor(dir) */
 	node_location get_neighbor(const geo::direction dir) const;
 	bool is_child_of(const node_location& other) const;
 	bool neighbors_with( const node_location& ) const;
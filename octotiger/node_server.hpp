@@ -19,6 +19,7 @@
 #include "octotiger/grid.hpp"
 #include "octotiger/node_client.hpp"
 #include "octotiger/node_location.hpp"
+#include "octotiger/numa_placement.hpp"
 #include "octotiger/profiler.hpp"
 #include "octotiger/io/silo.hpp"
 //#include "octotiger/struct_eos.hpp"
@@ -29,8 +30,11 @@
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 
@@ -59,6 +63,8 @@ private:
 		geo::direction direction;
 	};
 	integer position;
+	/* NUMA domain holding the grid (-1 until regrid_scatter placed it), see numa_placement.hpp */
+	std::int16_t numa_domain;
 	std::atomic<integer> refinement_flag;
 	node_location my_location;
 	integer step_num;
@@ -137,7 +143,7 @@ private:
 	static node_count_type cumulative_node_count;
 	static bool static_initialized;
 	static std::atomic<integer> static_initializing;
-	void initialize(real, real);
+	void initialize(real, real, std::shared_ptr<grid> migrated = nullptr);
 	void send_hydro_amr_boundaries(bool energy_only=false);
 	void collect_hydro_boundaries(bool energy_only=false);
 	static void static_initialize();
@@ -147,9 +153,6 @@ private:
 	hpx::future<void> nonrefined_step();
 	void refined_step();
 
-	diagnostics_t root_diagnostics(const diagnostics_t& diags);
-	diagnostics_t child_diagnostics(const diagnostics_t& diags);
-	diagnostics_t local_diagnostics(const diagnostics_t& diags);
 	hpx::future<real> local_step(integer steps);
 
 public:
@@ -181,6 +184,9 @@ public:
 	integer get_position() const {
 		return position;
 	}
+	const node_location& get_location() const {
+		return my_location;
+	}
 
 	void reconstruct_tree();
 
@@ -256,6 +262,14 @@ public:
 	int form_tree(hpx::id_type, hpx::id_type=hpx::invalid_id, std::vector<hpx::id_type> = std::vector<hpx::id_type>(geo::direction::count()));/**/
 	HPX_DEFINE_COMPONENT_ACTION(node_server, form_tree, form_tree_action);
 
+	/* form_tree without the per direction get_child_client calls (--form_tree_directory): every node
+	 * enters itself in its locality's directory at the end of regrid_scatter, the localities exchange
+	 * their directories once and then link all of their nodes locally */
+	using tree_directory_type = std::unordered_map<node_location::node_id, std::pair<hpx::id_type, bool>>;
+	static int form_tree_from_directory();
+	void add_to_tree_directory();
+	int link_from_directory(const tree_directory_type&);
+
 	std::uintptr_t get_ptr();/**/
 	HPX_DEFINE_COMPONENT_DIRECT_ACTION(node_server, get_ptr, get_ptr_action);
 
@@ -265,11 +279,11 @@ public:
 	std::pair<real,real> amr_error();
 	HPX_DEFINE_COMPONENT_ACTION(node_server, amr_error, amr_error_action);
 
-	diagnostics_t diagnostics(const diagnostics_t&);/**/
-	HPX_DEFINE_COMPONENT_ACTION(node_server, diagnostics, diagnostics_action);
-
 	diagnostics_t diagnostics();
 
+	/* at the root, the products of the request summed over all leaves */
+	insitu_t insitu(const insitu_t& request);
+
 	void set_aunt(const hpx::id_type&, const geo::face& face);/**/
 	HPX_DEFINE_COMPONENT_DIRECT_ACTION(node_server, set_aunt, set_aunt_action);
 
@@ -378,7 +392,6 @@ HPX_REGISTER_ACTION_DECLARATION(node_server::copy_to_locality_action);
 HPX_REGISTER_ACTION_DECLARATION(node_server::get_child_client_action);
 HPX_REGISTER_ACTION_DECLARATION(node_server::form_tree_action);
 HPX_REGISTER_ACTION_DECLARATION(node_server::get_ptr_action);
-HPX_REGISTER_ACTION_DECLARATION(node_server::diagnostics_action);
 HPX_REGISTER_ACTION_DECLARATION(node_server::timestep_driver_ascend_action);
 HPX_REGISTER_ACTION_DECLARATION(node_server::scf_params_action);
 HPX_REGISTER_ACTION_DECLARATION(node_server::send_rad_boundary_action);
@@ -0,0 +1,44 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUMA_PLACEMENT_HPP_
+#define NUMA_PLACEMENT_HPP_
+
+#include "octotiger/real.hpp"
+
+#include <hpx/include/parallel_executors.hpp>
+#include <hpx/include/threads.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace octotiger {
+namespace numa {
+
+/* Placement of sub-grids on the NUMA domains of their locality (--numa_placement).
+ *
+ * regrid_scatter numbers the sub-grids along the space filling curve of the tree and hands every
+ * locality a contiguous range of that order.  The same order is split once more inside the locality,
+ * so each domain owns a compact piece of the curve and most sibling boundaries stay on one socket.
+ * A node keeps its grid memory on its domain (see grid::rehome) and runs its step and boundary
+ * continuations through executor(), which hints the scheduler to use that domain's workers.
+ */
+
+/* Number of domains sub-grids are spread over, 1 if placement is off */
+std::size_t domain_count();
+
+/* Domain of the sub-grid at `position` of `total` in the regrid order */
+std::int16_t domain_of(integer position, integer total);
+
+using executor_type = hpx::parallel::execution::parallel_executor;
+
+/* Executor for tasks of a sub-grid on `domain` (no hint for a negative domain) */
+executor_type executor(std::int16_t domain,
+		hpx::threads::thread_priority priority = hpx::threads::thread_priority_boost);
+
+}
+}
+
+#endif /* NUMA_PLACEMENT_HPP_ */
@@ -28,6 +28,8 @@
 
  COMMAND_LINE_ENUM(eos_type,IDEAL,WD);
 
+ COMMAND_LINE_ENUM(rk_stage_type,SEPARATE,FUSED,VERIFY);
+
 class options {
 public:
 	int experiment;
@@ -48,10 +50,17 @@ public:
 	bool correct_am_hydro;
 	bool rotating_star_amr;
 	bool idle_rates;
+	bool scf_aitken;
+	bool fmm_float_boundaries;
+	bool numa_placement;
+	bool silo_float;
+	bool form_tree_directory;
 
 	integer scf_output_frequency;
+	integer scf_max_iterations;
 	integer silo_num_groups;
 	integer amrbnd_order;
+	integer griddim;
 	integer extra_regrid;
 	integer accretor_refine;
 	integer donor_refine;
@@ -62,8 +71,11 @@ public:
 	integer silo_offset_y;
 	integer silo_offset_z;
 	integer future_wait_time;
+	integer fmm_full_solve_interval;
+	integer insitu_resolution;
 
 	real rotating_star_x;
+	real scf_tolerance;
 	real dual_energy_sw2;
 	real dual_energy_sw1;
 	real hard_dt;
@@ -73,9 +85,11 @@ public:
 	real entropy_driving_time;
 	real omega;
 	real output_dt;
+	real insitu_dt;
 	real refinement_floor;
 	real stop_time;
 	real theta;
+	real fmm_tolerance;
 	real xscale;
 	real code_to_g;
 	real code_to_s;
@@ -87,12 +101,17 @@ public:
 	size_t cuda_streams_per_locality;
 	size_t cuda_streams_per_gpu;
 	size_t cuda_scheduling_threads;
+	size_t scratch_size;
 
 	std::string input_file;
 	std::string config_file;
 	std::string data_dir;
 	std::string output_filename;
 	std::string restart_filename;
+	std::string output_fields;
+	std::string silo_compression;
+	std::string insitu;
+	std::string insitu_fields;
 	integer n_species;
 	integer n_fields;
 
@@ -104,6 +123,8 @@ public:
 	interaction_kernel_type p2m_kernel_type;
 	interaction_kernel_type p2p_kernel_type;
 
+	rk_stage_type rk_stage;
+
 	std::vector<real> atomic_mass;
 	std::vector<real> atomic_number;
 	std::vector<real> X;
@@ -123,8 +144,12 @@ public:
 		arc & silo_offset_y;
 		arc & silo_offset_z;
 		arc & scf_output_frequency;
+		arc & scf_max_iterations;
+		arc & scf_tolerance;
+		arc & scf_aitken;
 		arc & silo_num_groups;
 		arc & amrbnd_order;
+		arc & griddim;
 		arc & dual_energy_sw1;
 		arc & dual_energy_sw2;
 		arc & hard_dt;
@@ -163,6 +188,11 @@ public:
 		arc & disable_diagnostics;
 		arc & disable_output;
 		arc & theta;
+		arc & fmm_tolerance;
+		arc & fmm_full_solve_interval;
+		arc & fmm_float_boundaries;
+		arc & numa_placement;
+		arc & form_tree_directory;
 		arc & core_refine;
 		arc & donor_refine;
 		arc & extra_regrid;
@@ -175,12 +205,21 @@ public:
 		arc & tmp;
 		eos = static_cast<eos_type>(tmp);
 		arc & data_dir;
+		arc & output_fields;
+		arc & silo_float;
+		arc & silo_compression;
+		arc & insitu;
+		arc & insitu_fields;
+		arc & insitu_dt;
+		arc & insitu_resolution;
 		arc & m2m_kernel_type;
 		arc & p2p_kernel_type;
 		arc & p2m_kernel_type;
+		arc & rk_stage;
 		arc & cuda_streams_per_locality;
 		arc & cuda_streams_per_gpu;
 		arc & cuda_scheduling_threads;
+		arc & scratch_size;
 		arc & atomic_mass;
 		arc & atomic_number;
 		arc & X;
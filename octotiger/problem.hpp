@@ -19,6 +19,22 @@ using analytic_func_type = init_func_type;
 using refine_test_type = std::function<bool(integer, integer, real, real, real,
     std::vector<real> const&, std::array<std::vector<real>, NDIM> const&)>;
 
+// A row of n cells along z, handed to the vectorized refinement criteria.
+// U[f] points at the first cell of the row inside the (ghost padded) grid,
+// so criteria read fields in place and form only the gradients they need.
+struct refine_pencil {
+    integer n;
+    real x;
+    real y;
+    real const* z;
+    std::vector<real const*> U;
+    real dudx(integer f, integer dim, integer k) const {
+        return (U[f][k + H_DN[dim]] - U[f][k - H_DN[dim]]) / 2.0;
+    }
+};
+using refine_pencil_test_type =
+    std::function<bool(integer, integer, refine_pencil const&)>;
+
 const static init_func_type null_problem = nullptr;
 OCTOTIGER_EXPORT std::vector<real> old_scf(
     real, real, real, real, real, real, real);
@@ -64,8 +80,21 @@ OCTOTIGER_EXPORT bool refine_blast(integer level, integer max_level, real x,
     real y, real z, std::vector<real> const& U,
     std::array<std::vector<real>, NDIM> const& dudx);
 
-OCTOTIGER_EXPORT void set_refine_test(const refine_test_type&);
+OCTOTIGER_EXPORT bool refine_pencil_test(
+    integer level, integer maxl, refine_pencil const& p);
+OCTOTIGER_EXPORT bool refine_pencil_test_moving_star(
+    integer level, integer maxl, refine_pencil const& p);
+OCTOTIGER_EXPORT bool refine_pencil_sod(
+    integer level, integer maxl, refine_pencil const& p);
+OCTOTIGER_EXPORT bool refine_pencil_blast(
+    integer level, integer maxl, refine_pencil const& p);
+OCTOTIGER_EXPORT bool refine_pencil_test_level(
+    integer level, integer maxl, refine_pencil const& p);
+
+OCTOTIGER_EXPORT void set_refine_test(
+    const refine_test_type&, const refine_pencil_test_type& = nullptr);
 OCTOTIGER_EXPORT refine_test_type get_refine_test();
+OCTOTIGER_EXPORT refine_pencil_test_type get_refine_pencil_test();
 OCTOTIGER_EXPORT void set_problem(const init_func_type&);
 OCTOTIGER_EXPORT void set_analytic(const analytic_func_type&);
 OCTOTIGER_EXPORT init_func_type get_problem();
@@ -0,0 +1,91 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SCRATCH_ARENA_HPP_
+#define SCRATCH_ARENA_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace octotiger {
+
+/* Per worker bump allocator for the short lived scratch arrays of the hydro, AMR and radiation kernels.
+ *
+ * Every worker thread owns one arena.  It is sized and first touched by that worker during start up
+ * (see reserve), so with pinned workers the pages end up on the worker's NUMA domain.  Memory is handed
+ * out through scratch_scope objects, which rewind the arena when they go out of scope, so a task only
+ * ever occupies the arena for as long as it runs.  Requests that do not fit are served from the heap
+ * and counted, the high water mark tells how large the arena should have been.
+ *
+ * A scope must not be held across a suspension point (GET(), future::get, ...), the task might resume
+ * on another worker while a different task is using this worker's arena.
+ */
+class scratch_arena {
+public:
+	struct mark_type {
+		std::size_t top;
+		std::size_t overflow;
+	};
+
+	scratch_arena();
+	~scratch_arena();
+	scratch_arena(const scratch_arena&) = delete;
+	scratch_arena& operator=(const scratch_arena&) = delete;
+
+	static scratch_arena& local();
+
+	/* Maxima / sums over all arenas of this locality */
+	static std::size_t high_water_mark();
+	static std::size_t overflow_count();
+
+	void reserve(std::size_t bytes);
+	void* allocate(std::size_t bytes);
+	mark_type mark() const {
+		return {top_, overflow_.size()};
+	}
+	void release(const mark_type&);
+
+	static constexpr std::size_t alignment = 64;
+
+private:
+	std::unique_ptr<char[]> block_;
+	std::size_t capacity_;
+	std::size_t top_;
+	std::size_t overflow_bytes_;
+	std::atomic<std::size_t> high_water_;
+	std::atomic<std::size_t> overflow_count_;
+	std::vector<std::pair<std::unique_ptr<char[]>, std::size_t>> overflow_;
+};
+
+class scratch_scope {
+public:
+	scratch_scope() :
+			arena_(scratch_arena::local()), mark_(arena_.mark()) {
+	}
+	~scratch_scope() {
+		arena_.release(mark_);
+	}
+	scratch_scope(const scratch_scope&) = delete;
+	scratch_scope& operator=(const scratch_scope&) = delete;
+
+	/* Uninitialized storage for n objects of type T, valid until the scope ends */
+	template<class T>
+	T* allocate(std::size_t n) {
+		static_assert(std::is_trivial<T>::value, "scratch arrays must hold trivial types");
+		return static_cast<T*>(arena_.allocate(n * sizeof(T)));
+	}
+
+private:
+	scratch_arena &arena_;
+	scratch_arena::mark_type mark_;
+};
+
+}
+
+#endif /* SCRATCH_ARENA_HPP_ */
@@ -14,6 +14,9 @@
 #include <octotiger/cuda_util/cuda_scheduler.hpp>
 #include <octotiger/common_kernel/struct_of_array_data.hpp>
 #include <octotiger/profiler.hpp>
+#include <octotiger/scratch_arena.hpp>
+
+#include <algorithm>
 
 template<class T>
 static inline bool PPM_test(const T &ql, const T &q0, const T &qr) {
@@ -106,7 +109,9 @@ void hydro_computer<NDIM, INX, PHYSICS>::reconstruct_ppm(std::vector<std::vector
 
 	static const cell_geometry<NDIM, INX> geo;
 	static constexpr auto dir = geo.direction();
-	static thread_local auto D1 = std::vector < safe_real > (geo.H_N3, 0.0);
+	octotiger::scratch_scope scratch;
+	auto *D1 = scratch.allocate<safe_real>(geo.H_N3);
+	std::fill(D1, D1 + geo.H_N3, 0.0);
 	for (int d = 0; d < geo.NDIR / 2; d++) {
 		const auto di = dir[d];
 		for (int j = 0; j < geo.H_NX_XM2; j++) {
@@ -218,10 +223,14 @@ inline safe_real ospre(safe_real a, safe_real b) {
 template<int NDIM, int INX, class PHYS>
 const hydro::recon_type<NDIM>& hydro_computer<NDIM, INX, PHYS>::reconstruct(const hydro::state_type &U_, const hydro::x_type &X, safe_real omega) {
 	PROFILE();
-	static thread_local auto AM = std::vector < std::vector < safe_real >> (geo::NANGMOM, std::vector < safe_real > (geo::H_N3));
 	static thread_local auto Q = std::vector < std::vector<std::vector<safe_real>>
 			> (nf_, std::vector < std::vector < safe_real >> (geo::NDIR, std::vector < safe_real > (geo::H_N3)));
-	static thread_local auto Theta = std::vector < safe_real > (geo::H_N3, 0.0);
+	octotiger::scratch_scope scratch;
+	std::array<safe_real*, geo::NANGMOM> AM;
+	for (int n = 0; n < geo::NANGMOM; n++) {
+		AM[n] = scratch.allocate<safe_real>(geo::H_N3);
+		std::fill(AM[n], AM[n] + geo::H_N3, 0.0);
+	}
 
 	static constexpr auto xloc = geo::xloc();
 	static constexpr auto levi_civita = geo::levi_civita();
@@ -0,0 +1,333 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Times the FMM interaction kernels on synthetic sub-grids, without a tree, channels or a time step.
+// Every run surrounds one sub-grid by 26 neighbors of a given refinement pattern and calls the
+// same interfaces node_server::compute_fmm uses.  Results are written as JSON.
+
+#include "octotiger/compute_factor.hpp"
+#include "octotiger/defs.hpp"
+#include "octotiger/grid.hpp"
+#include "octotiger/grid_fmm.hpp"
+#include "octotiger/interaction_types.hpp"
+#include "octotiger/options.hpp"
+#include "octotiger/common_kernel/interaction_constants.hpp"
+#include "octotiger/monopole_interactions/calculate_stencil.hpp"
+#include "octotiger/monopole_interactions/p2m_interaction_interface.hpp"
+#include "octotiger/monopole_interactions/p2p_interaction_interface.hpp"
+#include "octotiger/multipole_interactions/calculate_stencil.hpp"
+#include "octotiger/multipole_interactions/multipole_interaction_interface.hpp"
+
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/lcos.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace mono_inter = octotiger::fmm::monopole_interactions;
+namespace multi_inter = octotiger::fmm::multipole_interactions;
+
+struct bench_config {
+	const char *name;
+	bool center_leaf;
+	std::function<bool(const geo::direction&)> neighbor_leaf;
+};
+
+/* Neighbors in compute_fmm are always on the level of the sub-grid, a refined one sends multipoles and a leaf
+ * monopoles.  leaf_refined is a leaf among refined neighbors, the p2p plus p2m path. */
+const std::vector<bench_config> configs = { //
+		{ "all_monopole", true, [](const geo::direction&) {
+			return true;
+		} }, //
+		{ "all_multipole", false, [](const geo::direction&) {
+			return false;
+		} }, //
+		{ "mixed", false, [](const geo::direction &dir) {
+			return integer(dir) % 2 == 0;
+		} }, //
+		{ "leaf_refined", true, [](const geo::direction&) {
+			return false;
+		} } };
+
+const std::vector<std::pair<interaction_kernel_type, const char*>> kernel_types = { { SOA_CPU, "SOA_CPU" }, { OLD, "OLD" } };
+
+struct bench_result {
+	std::string config;
+	std::string kernel;
+	real theta;
+	std::size_t threads;
+	double seconds;
+	double cells_per_second;
+	double interactions_per_second;
+};
+
+/* Stencils are thread_local, same as init_thread_local_worker in the main frontend */
+void init_thread_stencils() {
+	using mono_inter_p2p = mono_inter::p2p_interaction_interface;
+	mono_inter_p2p::stencil() = mono_inter::calculate_stencil().first;
+	mono_inter_p2p::stencil_masks() = mono_inter::calculate_stencil_masks(mono_inter_p2p::stencil()).first;
+	mono_inter_p2p::four() = mono_inter::calculate_stencil().second;
+	mono_inter_p2p::stencil_four_constants() = mono_inter::calculate_stencil_masks(mono_inter_p2p::stencil()).second;
+	mono_inter::p2m_interaction_interface::stencil() = mono_inter::calculate_stencil().first;
+	using multi_inter_p2p = multi_inter::multipole_interaction_interface;
+	multi_inter_p2p::stencil() = multi_inter::calculate_stencil();
+	multi_inter_p2p::stencil_masks() = multi_inter::calculate_stencil_masks(multi_inter_p2p::stencil()).first;
+	multi_inter_p2p::inner_stencil_masks() = multi_inter::calculate_stencil_masks(multi_inter_p2p::stencil()).second;
+}
+
+std::shared_ptr<grid> make_leaf(real dx, const std::array<real, NDIM> &xmin, std::mt19937 &gen) {
+	std::uniform_real_distribution<real> dist(0.5, 1.5);
+	auto g = std::make_shared<grid>(dx, xmin);
+	g->set_leaf(true);
+	auto &rho = g->get_field(rho_i);
+	for (integer i = H_BW; i != H_NX - H_BW; ++i) {
+		for (integer j = H_BW; j != H_NX - H_BW; ++j) {
+			for (integer k = H_BW; k != H_NX - H_BW; ++k) {
+				rho[hindex(i, j, k)] = dist(gen);
+			}
+		}
+	}
+	return g;
+}
+
+/* A refined grid gets real multipoles, computed from eight synthetic leaf children */
+std::shared_ptr<grid> make_grid(bool leaf, real dx, const std::array<real, NDIM> &xmin, std::mt19937 &gen) {
+	if (leaf) {
+		auto g = make_leaf(dx, xmin, gen);
+		g->compute_multipoles(RHO);
+		return g;
+	}
+	multipole_pass_type m_out;
+	m_out.first.resize(INX * INX * INX);
+	m_out.second.resize(INX * INX * INX);
+	for (auto &ci : geo::octant::full_set()) {
+		const integer x0 = ci.get_side(XDIM) * INX / 2;
+		const integer y0 = ci.get_side(YDIM) * INX / 2;
+		const integer z0 = ci.get_side(ZDIM) * INX / 2;
+		std::array<real, NDIM> cmin = { xmin[XDIM] + x0 * dx, xmin[YDIM] + y0 * dx, xmin[ZDIM] + z0 * dx };
+		auto child = make_leaf(dx / 2.0, cmin, gen);
+		const auto m_in = child->compute_multipoles(RHO);
+		for (integer i = 0; i != INX / 2; ++i) {
+			for (integer j = 0; j != INX / 2; ++j) {
+				for (integer k = 0; k != INX / 2; ++k) {
+					const integer ii = i * INX * INX / 4 + j * INX / 2 + k;
+					const integer io = (i + x0) * INX * INX + (j + y0) * INX + k + z0;
+					m_out.first[io] = m_in.first[ii];
+					m_out.second[io] = m_in.second[ii];
+				}
+			}
+		}
+	}
+	auto g = make_leaf(dx, xmin, gen);
+	g->set_leaf(false);
+	g->compute_multipoles(RHO, &m_out);
+	return g;
+}
+
+/* Neighbor boundaries are built once per configuration and shared read-only by all tasks */
+struct bench_neighbors {
+	std::vector<std::shared_ptr<grid>> grids;
+	std::vector<neighbor_gravity_type> data;
+	bool contains_multipole;
+};
+
+bench_neighbors make_neighbors(const bench_config &cfg) {
+	const real dx = 1.0 / INX;
+	std::mt19937 gen(42);
+	bench_neighbors n;
+	n.data.resize(geo::direction::count());
+	n.contains_multipole = false;
+	for (auto const &dir : geo::direction::full_set()) {
+		std::array<real, NDIM> xmin = { dir[XDIM] * INX * dx, dir[YDIM] * INX * dx, dir[ZDIM] * INX * dx };
+		const bool leaf = cfg.neighbor_leaf(dir);
+		auto g = make_grid(leaf, dx, xmin, gen);
+		auto &nd = n.data[dir];
+		nd.data = g->get_gravity_boundary(dir.flip(), true);
+		nd.data.local_semaphore = nullptr;
+		nd.is_monopole = leaf;
+		nd.direction = dir;
+		n.contains_multipole = n.contains_multipole || !leaf;
+		n.grids.push_back(std::move(g));
+	}
+	return n;
+}
+
+/* Runs the interaction phase of compute_fmm on one sub-grid, returns the time spent in the timed loop */
+double time_interactions(const bench_config &cfg, const bench_neighbors &n, integer iterations) {
+	init_thread_stencils();
+	std::mt19937 gen(7);
+	const real dx = 1.0 / INX;
+	auto center = make_grid(cfg.center_leaf, dx, { 0.0, 0.0, 0.0 }, gen);
+	auto neighbors = n.data;
+	std::array<bool, geo::direction::count()> is_direction_empty;
+	std::fill(is_direction_empty.begin(), is_direction_empty.end(), false);
+	const auto &X = center->get_X();
+	std::array<real, NDIM> Xbase = { X[0][hindex(H_BW, H_BW, H_BW)], X[1][hindex(H_BW, H_BW, H_BW)], X[2][hindex(H_BW, H_BW, H_BW)] };
+
+	multi_inter::multipole_interaction_interface multipole_interactor;
+	mono_inter::p2p_interaction_interface p2p_interactor;
+	mono_inter::p2m_interaction_interface p2m_interactor;
+	multipole_interactor.set_grid_ptr(center);
+	p2p_interactor.set_grid_ptr(center);
+	p2m_interactor.set_grid_ptr(center);
+
+	const auto step = [&]() {
+		if (!center->get_leaf()) {
+			multipole_interactor.compute_multipole_interactions(center->get_mon(), center->get_M(), center->get_com_ptr(), neighbors, RHO, dx,
+					is_direction_empty, Xbase);
+		} else {
+			p2p_interactor.compute_p2p_interactions(center->get_mon(), neighbors, RHO, dx, is_direction_empty);
+			if (n.contains_multipole) {
+				p2m_interactor.compute_p2m_interactions(center->get_mon(), center->get_M(), center->get_com_ptr(), neighbors, RHO, is_direction_empty);
+			}
+		}
+	};
+	step();
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (integer i = 0; i != iterations; ++i) {
+		step();
+	}
+	return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void write_json(FILE *fp, const std::vector<bench_result> &results, integer iterations) {
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"subgrid\": %i,\n", int(INX));
+	fprintf(fp, "  \"os_threads\": %i,\n", int(hpx::get_os_thread_count()));
+	fprintf(fp, "  \"iterations\": %i,\n", int(iterations));
+	fprintf(fp, "  \"results\": [\n");
+	for (std::size_t i = 0; i != results.size(); ++i) {
+		const auto &r = results[i];
+		fprintf(fp, "    {\"config\": \"%s\", \"kernel\": \"%s\", \"theta\": %g, \"threads\": %i, \"seconds\": %e, "
+				"\"cells_per_second\": %e, \"interactions_per_second\": %e}%s\n", r.config.c_str(), r.kernel.c_str(), double(r.theta),
+				int(r.threads), r.seconds, r.cells_per_second, r.interactions_per_second, i + 1 == results.size() ? "" : ",");
+	}
+	fprintf(fp, "  ]\n}\n");
+}
+
+}
+
+int hpx_main(int argc, char *argv[]) {
+	namespace po = boost::program_options;
+	std::vector<real> thetas;
+	std::vector<std::size_t> thread_counts;
+	integer iterations;
+	std::string output;
+
+	po::options_description bench_opts("fmm_bench options");
+	bench_opts.add_options() //
+	("help", "produce help message") //
+	("bench_theta", po::value<std::vector<real>>(&thetas)->multitoken(), "opening criteria to sweep (default 0.34 0.5 0.7)") //
+	("bench_threads", po::value<std::vector<std::size_t>>(&thread_counts)->multitoken(), "concurrent sub-grids to sweep (default 1 and all workers)") //
+	("bench_iterations", po::value<integer>(&iterations)->default_value(100), "timed kernel calls per sub-grid") //
+	("bench_output", po::value<std::string>(&output)->default_value(""), "JSON output file (default stdout)") //
+			;
+	const auto parsed = po::command_line_parser(argc, argv).options(bench_opts).allow_unregistered().run();
+	po::variables_map vm;
+	po::store(parsed, vm);
+	po::notify(vm);
+	if (vm.count("help")) {
+		std::cout << bench_opts << "\n";
+		return hpx::finalize();
+	}
+
+	/* Everything else is handed to the regular Octo-Tiger option parser */
+	auto rest = po::collect_unrecognized(parsed.options, po::include_positional);
+	std::vector<char*> oargv = { argv[0] };
+	for (auto &arg : rest) {
+		oargv.push_back(&arg[0]);
+	}
+	if (!opts().process_options(int(oargv.size()), oargv.data())) {
+		return hpx::finalize();
+	}
+	options::all_localities = hpx::find_all_localities();
+	grid::static_init();
+	compute_factor();
+
+	const std::size_t os_threads = hpx::get_os_thread_count();
+	if (thetas.empty()) {
+		thetas = { 0.34, 0.5, 0.7 };
+	}
+	if (thread_counts.empty()) {
+		thread_counts = { 1 };
+		if (os_threads > 1) {
+			thread_counts.push_back(os_threads);
+		}
+	}
+
+	std::vector<bench_result> results;
+	for (const real theta : thetas) {
+		if (theta < octotiger::fmm::THETA_FLOOR) {
+			fprintf(stderr, "skipping theta %g, compiled minimum is %g\n", double(theta), double(octotiger::fmm::THETA_FLOOR));
+			continue;
+		}
+		opts().theta = theta;
+		compute_ilist();
+		const std::size_t p2p_stencil = mono_inter::calculate_stencil().first.size();
+		const std::size_t m2m_stencil = multi_inter::calculate_stencil().stencil_elements.size();
+		for (const auto &cfg : configs) {
+			const auto neighbors = make_neighbors(cfg);
+			const std::size_t stencil = cfg.center_leaf ? p2p_stencil : m2m_stencil;
+			for (const auto &kt : kernel_types) {
+				opts().m2m_kernel_type = opts().p2p_kernel_type = opts().p2m_kernel_type = kt.first;
+				for (const std::size_t threads : thread_counts) {
+					const std::size_t nthreads = std::min(threads, os_threads);
+					std::vector<hpx::future<double>> futs;
+					for (std::size_t t = 0; t != nthreads; ++t) {
+						futs.push_back(hpx::async([&cfg, &neighbors, iterations]() {
+							return time_interactions(cfg, neighbors, iterations);
+						}));
+					}
+					double seconds = 0.0;
+					for (auto &f : futs) {
+						seconds = std::max(seconds, f.get());
+					}
+					const double calls = double(nthreads) * iterations;
+					bench_result r;
+					r.config = cfg.name;
+					r.kernel = kt.second;
+					r.theta = theta;
+					r.threads = nthreads;
+					r.seconds = seconds;
+					r.cells_per_second = calls * INX * INX * INX / seconds;
+					r.interactions_per_second = calls * INX * INX * INX * stencil / seconds;
+					fprintf(stderr, "%-14s %-8s theta=%.2f threads=%3i %e cells/s\n", cfg.name, kt.second, double(theta), int(nthreads),
+							r.cells_per_second);
+					results.push_back(r);
+				}
+			}
+		}
+	}
+
+	if (output.empty()) {
+		write_json(stdout, results, iterations);
+	} else {
+		FILE *fp = fopen(output.c_str(), "wt");
+		if (fp == NULL) {
+			printf("Unable to open %s\n", output.c_str());
+			return hpx::finalize();
+		}
+		write_json(fp, results, iterations);
+		fclose(fp);
+	}
+	return hpx::finalize();
+}
+
+int main(int argc, char *argv[]) {
+	std::vector<std::string> cfg = { "hpx.commandline.allow_unknown=1" };
+	return hpx::init(argc, argv, cfg);
+}
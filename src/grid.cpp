@@ -15,6 +15,7 @@
 #include "octotiger/options.hpp"
 #include "octotiger/problem.hpp"
 #include "octotiger/profiler.hpp"
+#include "octotiger/scratch_arena.hpp"
 #include "octotiger/io/silo.hpp"
 #include "octotiger/taylor.hpp"
 #include "octotiger/unitiger/hydro.hpp"
@@ -26,10 +27,14 @@
 #include <hpx/collectives/broadcast.hpp>
 #include <hpx/synchronization/once.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 
 std::vector<int> grid::field_bw;
@@ -44,6 +49,11 @@ bool grid::is_hydro_field(const std::string &str) {
 	return str_to_index_hydro.find(str) != str_to_index_hydro.end();
 }
 
+int grid::hydro_field_index(const std::string &str) {
+	const auto i = str_to_index_hydro.find(str);
+	return i == str_to_index_hydro.end() ? -1 : i->second;
+}
+
 std::vector<std::pair<std::string, real>> grid::get_outflows() const {
 	std::vector<std::pair<std::string, real>> rc;
 	rc.reserve(str_to_index_hydro.size());
@@ -1336,58 +1346,65 @@ std::vector<real> grid::l_sums() const {
 bool grid::refine_me(integer lev, integer last_ngrids) const {
 	PROFILE();
 
-	auto test = get_refine_test();
 	if (lev < 1) {
 
 		return true;
 	}
-	bool rc = false;
-	std::vector<real> state(opts().n_fields);
+	const auto pencil_test = get_refine_pencil_test();
+	const auto test = get_refine_test();
+	refine_pencil pencil;
+	pencil.U.resize(opts().n_fields);
+	std::vector<real> state;
 	std::array<std::vector<real>, NDIM> dud;
-	std::vector<real> &dudx = dud[0];
-	std::vector<real> &dudy = dud[1];
-	std::vector<real> &dudz = dud[2];
-	dudx.resize(opts().n_fields);
-	dudy.resize(opts().n_fields);
-	dudz.resize(opts().n_fields);
-	for (integer i = H_BW - REFINE_BW; i != H_NX - H_BW + REFINE_BW; ++i) {
-		for (integer j = H_BW - REFINE_BW; j != H_NX - H_BW + REFINE_BW; ++j) {
-			for (integer k = H_BW - REFINE_BW; k != H_NX - H_BW + REFINE_BW; ++k) {
-				int cnt = 0;
-				if (i < H_BW || i >= H_NX - H_BW) {
-					++cnt;
-				}
-				if (j < H_BW || j >= H_NX - H_BW) {
-					++cnt;
-				}
-				if (k < H_BW || k >= H_NX - H_BW) {
-					++cnt;
-				}
-				if (cnt > 1) {
-					continue;
-				}
-				const integer iii = hindex(i, j, k);
-				for (integer i = 0; i != opts().n_fields; ++i) {
-					state[i] = U[i][iii];
-					dudx[i] = (U[i][iii + H_DNX] - U[i][iii - H_DNX]) / 2.0;
-					dudy[i] = (U[i][iii + H_DNY] - U[i][iii - H_DNY]) / 2.0;
-					dudz[i] = (U[i][iii + H_DNZ] - U[i][iii - H_DNZ]) / 2.0;
+	if (!pencil_test) {
+		state.resize(opts().n_fields);
+		for (auto &d : dud) {
+			d.resize(opts().n_fields);
+		}
+	}
+	constexpr integer lb = H_BW - REFINE_BW;
+	constexpr integer ub = H_NX - H_BW + REFINE_BW;
+	const auto is_ghost = [](integer i) {
+		return i < H_BW || i >= H_NX - H_BW;
+	};
+	/* Cells in the REFINE_BW ghost layer count only if at most one of their indices is a ghost index, *
+	 * so each (i,j) row along z is either skipped, limited to the interior, or taken whole           */
+	for (integer i = lb; i != ub; ++i) {
+		for (integer j = lb; j != ub; ++j) {
+			const integer cnt = integer(is_ghost(i)) + integer(is_ghost(j));
+			if (cnt > 1) {
+				continue;
+			}
+			const integer k0 = cnt ? H_BW : lb;
+			const integer k1 = cnt ? H_NX - H_BW : ub;
+			const integer iii0 = hindex(i, j, k0);
+			if (pencil_test) {
+				pencil.n = k1 - k0;
+				pencil.x = X[XDIM][iii0];
+				pencil.y = X[YDIM][iii0];
+				pencil.z = X[ZDIM].data() + iii0;
+				for (integer f = 0; f != opts().n_fields; ++f) {
+					pencil.U[f] = U[f].data() + iii0;
+				}
+				if (pencil_test(lev, max_level, pencil)) {
+					return true;
 				}
-				if (test(lev, max_level, X[XDIM][iii], X[YDIM][iii], X[ZDIM][iii], state, dud)) {
-					rc = true;
-					break;
+			} else {
+				for (integer iii = iii0; iii != iii0 + k1 - k0; ++iii) {
+					for (integer f = 0; f != opts().n_fields; ++f) {
+						state[f] = U[f][iii];
+						dud[XDIM][f] = (U[f][iii + H_DNX] - U[f][iii - H_DNX]) / 2.0;
+						dud[YDIM][f] = (U[f][iii + H_DNY] - U[f][iii - H_DNY]) / 2.0;
+						dud[ZDIM][f] = (U[f][iii + H_DNZ] - U[f][iii - H_DNZ]) / 2.0;
+					}
+					if (test(lev, max_level, X[XDIM][iii], X[YDIM][iii], X[ZDIM][iii], state, dud)) {
+						return true;
+					}
 				}
-
-			}
-			if (rc) {
-				break;
 			}
 		}
-		if (rc) {
-			break;
-		}
 	}
-	return rc;
+	return false;
 }
 
 void grid::rho_mult(real f0, real f1) {
@@ -1416,15 +1433,16 @@ void grid::rho_mult(real f0, real f1) {
 
 void grid::rho_move(real x) {
 	real w = x / dx;
-	U0 = U;
+	/* a copy of the species only, U0 keeps the RK base state */
+	const std::vector<std::vector<safe_real>> Us(U.begin() + spc_i, U.begin() + spc_i + opts().n_species);
 
 	w = std::max(-0.5, std::min(0.5, w));
 	for (integer i = 1; i != H_NX - 1; ++i) {
 		for (integer j = 1; j != H_NX - 1; ++j) {
 			for (integer k = 1; k != H_NX - 1; ++k) {
 				for (integer si = spc_i; si != opts().n_species + spc_i; ++si) {
-					U[si][hindex(i, j, k)] += w * U0[si][hindex(i + 1, j, k)];
-					U[si][hindex(i, j, k)] -= w * U0[si][hindex(i - 1, j, k)];
+					U[si][hindex(i, j, k)] += w * Us[si - spc_i][hindex(i + 1, j, k)];
+					U[si][hindex(i, j, k)] -= w * Us[si - spc_i][hindex(i - 1, j, k)];
 					U[si][hindex(i, j, k)] = std::max((double) U[si][hindex(i, j, k)], 0.0);
 				}
 				U[rho_i][hindex(i, j, k)] = 0.0;
@@ -1475,7 +1493,7 @@ space_vector grid::center_of_mass() const {
 }
 
 grid::grid(real _dx, std::array<real, NDIM> _xmin) :
-		is_coarse(H_N3), has_coarse(H_N3), Ushad(opts().n_fields), U(opts().n_fields), U0(opts().n_fields), dUdt(opts().n_fields), F(NDIM), X(NDIM), G(NGF), is_root(
+		is_coarse(H_N3), has_coarse(H_N3), amr_dirs(NDIR), Ushad(opts().n_fields), U(opts().n_fields), U0(opts().n_fields), dUdt(opts().n_fields), F(NDIM), X(NDIM), G(NGF), is_root(
 				false), is_leaf(true) {
 	dx = _dx;
 	xmin = _xmin;
@@ -1645,13 +1663,13 @@ void grid::allocate() {
 }
 
 grid::grid() :
-		is_coarse(H_N3), has_coarse(H_N3), Ushad(opts().n_fields), U(opts().n_fields), U0(opts().n_fields), dUdt(opts().n_fields), F(NDIM), X(NDIM), G(NGF), dphi_dt(
+		is_coarse(H_N3), has_coarse(H_N3), amr_dirs(NDIR), Ushad(opts().n_fields), U(opts().n_fields), U0(opts().n_fields), dUdt(opts().n_fields), F(NDIM), X(NDIM), G(NGF), dphi_dt(
 				H_N3), is_root(false), is_leaf(true), U_out(opts().n_fields, ZERO), U_out0(opts().n_fields, ZERO) {
 //	allocate();
 }
 
 grid::grid(const init_func_type &init_func, real _dx, std::array<real, NDIM> _xmin) :
-		is_coarse(H_N3), has_coarse(H_N3), Ushad(opts().n_fields), U(opts().n_fields), U0(opts().n_fields), dUdt(opts().n_fields), F(NDIM), X(NDIM), G(NGF), is_root(
+		is_coarse(H_N3), has_coarse(H_N3), amr_dirs(NDIR), Ushad(opts().n_fields), U(opts().n_fields), U0(opts().n_fields), dUdt(opts().n_fields), F(NDIM), X(NDIM), G(NGF), is_root(
 				false), is_leaf(true), U_out(opts().n_fields, ZERO), U_out0(opts().n_fields, ZERO), dphi_dt(H_N3) {
 
 	dx = _dx;
@@ -1775,13 +1793,13 @@ void grid::set_max_level(integer l) {
 
 void grid::store() {
 	PROFILE();
+	/* z is the unit stride in both layouts, so the interior is INX * INX contiguous rows */
 	for (integer field = 0; field != opts().n_fields; ++field) {
-#pragma GCC ivdep
+		const auto *u = U[field].data();
+		auto *u0 = U0[field].data();
 		for (integer i = 0; i != INX; ++i) {
 			for (integer j = 0; j != INX; ++j) {
-				for (integer k = 0; k != INX; ++k) {
-					U0[field][h0index(i, j, k)] = U[field][hindex(i + H_BW, j + H_BW, k + H_BW)];
-				}
+				std::copy_n(u + hindex(i + H_BW, j + H_BW, H_BW), INX, u0 + h0index(i, j, 0));
 			}
 		}
 	}
@@ -1790,18 +1808,66 @@ void grid::store() {
 
 void grid::restore() {
 	for (integer field = 0; field != opts().n_fields; ++field) {
-#pragma GCC ivdep
+		const auto *u0 = U0[field].data();
+		auto *u = U[field].data();
 		for (integer i = 0; i != INX; ++i) {
 			for (integer j = 0; j != INX; ++j) {
-				for (integer k = 0; k != INX; ++k) {
-					U[field][h0index(i, j, k)] = U0[field][hindex(i + H_BW, j + H_BW, k + H_BW)];
-				}
+				std::copy_n(u0 + h0index(i, j, 0), INX, u + hindex(i + H_BW, j + H_BW, H_BW));
 			}
 		}
 	}
 	U_out = U_out0;
 }
 
+std::vector<real> grid::pack_hydro() const {
+	std::vector<real> data;
+	data.reserve(U.size() * H_N3);
+	for (const auto &u : U) {
+		data.insert(data.end(), u.begin(), u.end());
+	}
+	return data;
+}
+
+void grid::unpack_hydro(const std::vector<real> &data) {
+	assert(data.size() == U.size() * H_N3);
+	auto src = data.begin();
+	for (auto &u : U) {
+		std::copy(src, src + H_N3, u.begin());
+		src += H_N3;
+	}
+}
+
+void grid::rehome() {
+	PROFILE();
+	const auto fresh = [](auto &v) {
+		std::decay_t<decltype(v)>(v).swap(v);
+	};
+	const auto fresh_shared = [](auto &p) {
+		if (p != nullptr) {
+			p = std::make_shared<typename std::decay_t<decltype(p)>::element_type>(*p);
+		}
+	};
+	fresh(U);
+	fresh(U0);
+	fresh(dUdt);
+	fresh(F);
+	fresh(X);
+	fresh(G);
+	fresh(Ushad);
+	fresh(L);
+	fresh(L_c);
+	fresh(dphi_dt);
+	fresh(roche_lobe);
+	fresh(fmm_source_ref);
+	fresh(fmm_L_cache);
+	fresh(fmm_L_c_cache);
+	fresh_shared(M_ptr);
+	fresh_shared(mon_ptr);
+	for (auto &c : com_ptr) {
+		fresh_shared(c);
+	}
+}
+
 void grid::set_physical_boundaries(const geo::face &face, real t) {
 	PROFILE();
 	const auto dim = face.get_dimension();
@@ -2121,9 +2187,6 @@ void grid::next_u(integer rk, real t, real dt) {
 		}
 	}
 
-	std::vector<real> du_out(opts().n_fields, ZERO);
-
-	std::vector<real> ds(NDIM, ZERO);
 	for (integer i = H_BW; i != H_NX - H_BW; ++i) {
 		for (integer j = H_BW; j != H_NX - H_BW; ++j) {
 #pragma GCC ivdep
@@ -2139,6 +2202,23 @@ void grid::next_u(integer rk, real t, real dt) {
 		}
 	}
 
+	update_outflows(rk, dt);
+
+	for (integer i = H_BW; i != H_NX - H_BW; ++i) {
+		for (integer j = H_BW; j != H_NX - H_BW; ++j) {
+			for (integer k = H_BW; k != H_NX - H_BW; ++k) {
+				enforce_floors(i, j, k);
+			}
+		}
+	}
+}
+
+void grid::update_outflows(integer rk, real dt) {
+	octotiger::scratch_scope scratch;
+	auto *du_out = scratch.allocate<real>(opts().n_fields);
+	auto *du = scratch.allocate<real>(opts().n_fields);
+	std::fill(du_out, du_out + opts().n_fields, ZERO);
+
 	du_out[sx_i] += omega * U_out[sy_i] * dt;
 	du_out[sy_i] -= omega * U_out[sx_i] * dt;
 
@@ -2158,7 +2238,6 @@ void grid::next_u(integer rk, real t, real dt) {
 			const integer iii_m = H_DNX * (H_BW) + H_DNY * i + H_DNZ * j;
 			const integer jjj_m = H_DNY * (H_BW) + H_DNZ * i + H_DNX * j;
 			const integer kkk_m = H_DNZ * (H_BW) + H_DNX * i + H_DNY * j;
-			std::vector<real> du(opts().n_fields);
 			for (integer field = 0; field != opts().n_fields; ++field) {
 				du[field] = ZERO;
 				if (X[XDIM][iii_p] > scaling_factor) {
@@ -2191,32 +2270,186 @@ void grid::next_u(integer rk, real t, real dt) {
 		const real out0 = U_out0[field];
 		U_out[field] = (ONE - rk_beta[rk]) * out0 + rk_beta[rk] * out1;
 	}
+}
+
+void grid::enforce_floors(integer i, integer j, integer k) {
+	const integer iii = hindex(i, j, k);
+	if (opts().tau_floor > 0.0) {
+		U[tau_i][iii] = std::max(U[tau_i][iii], opts().tau_floor);
+	} else if (U[tau_i][iii] < ZERO) {
+		printf("Tau is negative- %e %i %i %i  %e %e %e\n", real(U[tau_i][iii]), int(i), int(j), int(k), (double) X[XDIM][iii],
+				(double) X[YDIM][iii], (double) X[ZDIM][iii]);
+		abort();
+	}
+	if (opts().rho_floor > 0.0) {
+		const auto dif = std::max(U[rho_i][iii], opts().rho_floor) - U[rho_i][iii];
+		U[rho_i][iii] += dif;
+		for (int s = 0; s < opts().n_species; s++) {
+			U[spc_i + s][iii] += dif / opts().n_species;
+		}
+	} else if (U[rho_i][iii] <= ZERO) {
+		printf("Rho is non-positive - %e %i %i %i %e %e %e\n", real(U[rho_i][iii]), int(i), int(j), int(k), real(X[XDIM][iii]), real(X[YDIM][iii]),
+				real(X[ZDIM][iii]));
+		abort();
+	}
+}
+
+void grid::compute_drho_dt() {
+	PROFILE();
 	for (integer i = H_BW; i != H_NX - H_BW; ++i) {
 		for (integer j = H_BW; j != H_NX - H_BW; ++j) {
 #pragma GCC ivdep
 			for (integer k = H_BW; k != H_NX - H_BW; ++k) {
+				const integer iii0 = h0index(i - H_BW, j - H_BW, k - H_BW);
+				const integer iiif = findex(i - H_BW, j - H_BW, k - H_BW);
+				dUdt[rho_i][iii0] = ZERO;
+				dUdt[rho_i][iii0] -= (F[XDIM][rho_i][iiif + F_DNX] - F[XDIM][rho_i][iiif]) / dx;
+				dUdt[rho_i][iii0] -= (F[YDIM][rho_i][iiif + F_DNY] - F[YDIM][rho_i][iiif]) / dx;
+				dUdt[rho_i][iii0] -= (F[ZDIM][rho_i][iiif + F_DNZ] - F[ZDIM][rho_i][iiif]) / dx;
+			}
+		}
+	}
+}
+
+/* Same operations in the same order as compute_sources, compute_dudt and next_u, but the time derivative
+ * of a cell lives in registers instead of dUdt.  Only dUdt[rho_i] (compute_drho_dt) is read. */
+void grid::next_u_fused(integer rk, real t, real rotational_time, real dt) {
+	PROFILE();
+	if (!opts().hydro) {
+		return;
+	}
+	const integer nf = opts().n_fields;
+	octotiger::scratch_scope scratch;
+	auto *src = scratch.allocate<real>(nf);
+	const bool driving = opts().driving_rate != 0.0 && opts().driving_time > rotational_time / (2.0 * M_PI);
+	const bool entropy_driving = opts().entropy_driving_rate != 0.0 && opts().entropy_driving_time > rotational_time / (2.0 * M_PI);
+	for (integer i = H_BW; i != H_NX - H_BW; ++i) {
+		for (integer j = H_BW; j != H_NX - H_BW; ++j) {
+			for (integer k = H_BW; k != H_NX - H_BW; ++k) {
+				const integer iii0 = h0index(i - H_BW, j - H_BW, k - H_BW);
 				const integer iii = hindex(i, j, k);
-				if (opts().tau_floor > 0.0) {
-					U[tau_i][iii] = std::max(U[tau_i][iii], opts().tau_floor);
-				} else if (U[tau_i][iii] < ZERO) {
-					printf("Tau is negative- %e %i %i %i  %e %e %e\n", real(U[tau_i][iii]), int(i), int(j), int(k), (double) X[XDIM][iii],
-							(double) X[YDIM][iii], (double) X[ZDIM][iii]);
-					abort();
+				const integer iiif = findex(i - H_BW, j - H_BW, k - H_BW);
+				const integer iiig = gindex(i - H_BW, j - H_BW, k - H_BW);
+
+				/* compute_sources */
+				for (integer field = 0; field != nf; ++field) {
+					src[field] = ZERO;
+				}
+				const real rho = U[rho_i][iii];
+				if (opts().gravity) {
+					src[sx_i] += rho * G[iiig][gx_i];
+					src[sy_i] += rho * G[iiig][gy_i];
+					src[sz_i] += rho * G[iiig][gz_i];
+					src[egas_i] -= omega * X[YDIM][iii] * rho * G[iiig][gx_i];
+					src[egas_i] += omega * X[XDIM][iii] * rho * G[iiig][gy_i];
 				}
-				if (opts().rho_floor > 0.0) {
-					const auto dif = std::max(U[rho_i][iii], opts().rho_floor) - U[rho_i][iii];
-					U[rho_i][iii] += dif;
-					for (int s = 0; s < opts().n_species; s++) {
-						U[spc_i + s][iii] += dif / opts().n_species;
+				if (driving) {
+					const real period_len = 2.0 * M_PI / grid::omega;
+					const real ff = -opts().driving_rate / period_len;
+					const real sx = U[sx_i][iii];
+					const real sy = U[sy_i][iii];
+					const real x = X[XDIM][iii];
+					const real y = X[YDIM][iii];
+					const real R = std::sqrt(x * x + y * y);
+					const real lz = (x * sy - y * sx);
+					const real dsx = -y / R / R * lz * ff;
+					const real dsy = +x / R / R * lz * ff;
+					src[sx_i] += dsx;
+					src[sy_i] += dsy;
+					src[egas_i] += (sx * dsx + sy * dsy) / rho;
+				}
+				if (entropy_driving) {
+					constexpr integer spc_ac_i = spc_i;
+					constexpr integer spc_ae_i = spc_i + 1;
+					const real period_len = 2.0 * M_PI / grid::omega;
+					real ff = +opts().entropy_driving_rate / period_len;
+					ff *= (U[spc_ac_i][iii] + U[spc_ae_i][iii]) / U[rho_i][iii];
+					real ek = ZERO;
+					ek += HALF * pow(U[sx_i][iii], 2) / U[rho_i][iii];
+					ek += HALF * pow(U[sy_i][iii], 2) / U[rho_i][iii];
+					ek += HALF * pow(U[sz_i][iii], 2) / U[rho_i][iii];
+					real ei;
+					if (opts().eos == WD) {
+						ei = U[egas_i][iii] - ek - ztwd_energy(U[rho_i][iii]);
+					} else {
+						ei = U[egas_i][iii] - ek;
 					}
-				} else if (U[rho_i][iii] <= ZERO) {
-					printf("Rho is non-positive - %e %i %i %i %e %e %e\n", real(U[rho_i][iii]), int(i), int(j), int(k), real(X[XDIM][iii]), real(X[YDIM][iii]),
-							real(X[ZDIM][iii]));
-					abort();
+					real et = U[egas_i][iii];
+					real tau;
+					if (ei < de_switch2 * et) {
+						tau = U[tau_i][iii];
+					} else {
+						tau = std::pow(ei, 1.0 / fgamma);
+					}
+					ei = std::pow(tau, fgamma);
+					const real dtau = ff * tau;
+					const real dei = dtau * ei / tau * fgamma;
+					src[tau_i] += dtau;
+					src[egas_i] += dei;
+				}
+				src[lx_i] += X[YDIM][iii] * src[sz_i] - X[ZDIM][iii] * src[sy_i];
+				src[ly_i] -= X[XDIM][iii] * src[sz_i] - X[ZDIM][iii] * src[sx_i];
+				src[lz_i] += X[XDIM][iii] * src[sy_i] - X[YDIM][iii] * src[sx_i];
+				src[sx_i] += omega * U[sy_i][iii];
+				src[sy_i] -= omega * U[sx_i][iii];
+				src[lx_i] += omega * U[ly_i][iii];
+				src[ly_i] -= omega * U[lx_i][iii];
+
+				/* compute_dudt */
+				for (integer field = 0; field != nf; ++field) {
+					src[field] -= (F[XDIM][field][iiif + F_DNX] - F[XDIM][field][iiif]) / dx;
+					src[field] -= (F[YDIM][field][iiif + F_DNY] - F[YDIM][field][iiif]) / dx;
+					src[field] -= (F[ZDIM][field][iiif + F_DNZ] - F[ZDIM][field][iiif]) / dx;
+				}
+				if (opts().gravity) {
+					src[egas_i] += src[pot_i];
+					src[pot_i] = ZERO;
+					src[egas_i] -= (dUdt[rho_i][iii0] * G[iiig][phi_i]) * HALF;
+				}
+
+				/* next_u */
+				src[egas_i] += (dphi_dt[iii0] * U[rho_i][iii]) * HALF;
+				for (integer field = 0; field != nf; ++field) {
+					const real u1 = U[field][iii] + src[field] * dt;
+					const real u0 = U0[field][iii0];
+					U[field][iii] = (ONE - rk_beta[rk]) * u0 + rk_beta[rk] * u1;
 				}
+				enforce_floors(i, j, k);
 			}
 		}
 	}
+	update_outflows(rk, dt);
+}
+
+void grid::verify_next_u_fused(integer rk, real t, real rotational_time, real dt) {
+	const auto U_start = U;
+	const auto U_out_start = U_out;
+	next_u(rk, t, dt);
+	auto U_separate = std::move(U);
+	auto U_out_separate = std::move(U_out);
+	U = U_start;
+	U_out = U_out_start;
+	next_u_fused(rk, t, rotational_time, dt);
+	const auto differs = [](real a, real b) {
+		return std::memcmp(&a, &b, sizeof(real)) != 0;
+	};
+	integer count = 0;
+	for (integer field = 0; field != opts().n_fields; ++field) {
+		for (integer i = H_BW; i != H_NX - H_BW; ++i) {
+			for (integer j = H_BW; j != H_NX - H_BW; ++j) {
+				for (integer k = H_BW; k != H_NX - H_BW; ++k) {
+					const integer iii = hindex(i, j, k);
+					count += differs(U[field][iii], U_separate[field][iii]);
+				}
+			}
+		}
+		count += differs(U_out[field], U_out_separate[field]);
+	}
+	if (count != 0) {
+		printf("fused RK stage differs from the separate sweeps in %i values (rk = %i, dx = %e)\n", int(count), int(rk), dx);
+	}
+	U = std::move(U_separate);
+	U_out = std::move(U_out_separate);
 }
 
 void grid::dual_energy_update() {
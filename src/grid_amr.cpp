@@ -4,6 +4,7 @@
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include "octotiger/grid.hpp"
+#include "octotiger/scratch_arena.hpp"
 #include "octotiger/test_problems/amr/amr.hpp"
 #include "octotiger/unitiger/util.hpp"
 
@@ -30,6 +31,7 @@ void grid::set_hydro_amr_boundary(const std::vector<real> &data, const geo::dire
 	std::array<integer, NDIM> lb, ub;
 	int l = 0;
 	get_boundary_size(lb, ub, dir, OUTER, INX / 2, H_BW);
+	amr_dirs[dir] = 1;
 	for (int i = lb[0]; i < ub[0]; i++) {
 		for (int j = lb[1]; j < ub[1]; j++) {
 			for (int k = lb[2]; k < ub[2]; k++) {
@@ -59,11 +61,70 @@ void grid::set_hydro_amr_boundary(const std::vector<real> &data, const geo::dire
 	assert(l == data.size());
 }
 
+namespace {
+
+// Flattened Ushad offsets of the seven limited differences (x, y, z, xy, yz, xz, xyz) used to
+// prolong a coarse cell onto each of its eight children. Child c = 4 * ir + 2 * jr + kr.
+struct amr_prolong_stencil {
+	static constexpr int NCHILD = 8;
+	static constexpr int NDIFF = 7;
+	std::array<std::array<int, NCHILD>, NDIFF> offset;
+	amr_prolong_stencil() {
+		for (int ir = 0; ir < 2; ir++) {
+			for (int jr = 0; jr < 2; jr++) {
+				for (int kr = 0; kr < 2; kr++) {
+					const int c = 4 * ir + 2 * jr + kr;
+					const int is = ir ? +HS_DNX : -HS_DNX;
+					const int js = jr ? +HS_DNY : -HS_DNY;
+					const int ks = kr ? +HS_DNZ : -HS_DNZ;
+					offset[0][c] = is;
+					offset[1][c] = js;
+					offset[2][c] = ks;
+					offset[3][c] = is + js;
+					offset[4][c] = js + ks;
+					offset[5][c] = is + ks;
+					offset[6][c] = is + js + ks;
+				}
+			}
+		}
+	}
+};
+
+const amr_prolong_stencil amr_stencil;
+
+}
+
 void grid::complete_hydro_amr_boundary(bool energy_only) {
 	PROFILE();
+	constexpr int NCHILD = amr_prolong_stencil::NCHILD;
+	constexpr int NDIFF = amr_prolong_stencil::NDIFF;
+	using oct_array = std::array<double, NCHILD>;
 
-	using oct_array = std::array<std::array<std::array<double, 2>, 2>, 2>;
-	static thread_local std::vector<std::vector<oct_array>> Uf(opts().n_fields, std::vector<oct_array>(HS_N3));
+	/* The coarse cells only change with the AMR boundary directions, so we gather them once per *
+	 * set of directions and only visit those below instead of testing is_coarse for every cell   */
+	integer dirs = 0;
+	for (integer d = 0; d != NDIR; ++d) {
+		if (amr_dirs[d]) {
+			dirs |= integer(1) << d;
+		}
+	}
+	if (dirs != amr_coarse_dirs) {
+		amr_coarse_list.clear();
+		for (int i0 = 1; i0 < HS_NX - 1; i0++) {
+			for (int j0 = 1; j0 < HS_NX - 1; j0++) {
+				for (int k0 = 1; k0 < HS_NX - 1; k0++) {
+					const int iii0 = hSindex(i0, j0, k0);
+					if (is_coarse[iii0]) {
+						amr_coarse_list.push_back(iii0);
+					}
+				}
+			}
+		}
+		amr_coarse_dirs = dirs;
+	}
+	if (amr_coarse_list.empty()) {
+		return;
+	}
 
 	std::array<double, NDIM> xmin;
 	for (int dim = 0; dim < NDIM; dim++) {
@@ -74,133 +135,83 @@ void grid::complete_hydro_amr_boundary(bool energy_only) {
 		return minmod_theta(a, b, 64./37.);
 	};
 
-	for (int f = 0; f < opts().n_fields; f++) {
-		if (!energy_only || f == egas_i) {
+	const int f0 = energy_only ? egas_i : 0;
+	const int f1 = energy_only ? egas_i + 1 : opts().n_fields;
+	octotiger::scratch_scope scratch;
+	auto *Uf = scratch.allocate<oct_array>(opts().n_fields);
 
-			for (int i0 = 1; i0 < HS_NX - 1; i0++) {
-				for (int j0 = 1; j0 < HS_NX - 1; j0++) {
-					for (int k0 = 1; k0 < HS_NX - 1; k0++) {
-						const int iii0 = hSindex(i0, j0, k0);
-						if (is_coarse[iii0]) {
-							for (int ir = 0; ir < 2; ir++) {
-								for (int jr = 0; jr < 2; jr++) {
-									for (int kr = 0; kr < 2; kr++) {
-										const auto is = ir % 2 ? +1 : -1;
-										const auto js = jr % 2 ? +1 : -1;
-										const auto ks = kr % 2 ? +1 : -1;
-										const auto &u0 = Ushad[f][iii0];
-										const auto &uc = Ushad[f];
-										const auto s_x = limiter(uc[iii0 + is * HS_DNX] - u0, u0 - uc[iii0 - is * HS_DNX]);
-										const auto s_y = limiter(uc[iii0 + js * HS_DNY] - u0, u0 - uc[iii0 - js * HS_DNY]);
-										const auto s_z = limiter(uc[iii0 + ks * HS_DNZ] - u0, u0 - uc[iii0 - ks * HS_DNZ]);
-										const auto s_xy = limiter(uc[iii0 + is * HS_DNX + js * HS_DNY] - u0, u0 - uc[iii0 - is * HS_DNX - js * HS_DNY]);
-										const auto s_xz = limiter(uc[iii0 + is * HS_DNX + ks * HS_DNZ] - u0, u0 - uc[iii0 - is * HS_DNX - ks * HS_DNZ]);
-										const auto s_yz = limiter(uc[iii0 + js * HS_DNY + ks * HS_DNZ] - u0, u0 - uc[iii0 - js * HS_DNY - ks * HS_DNZ]);
-										const auto s_xyz = limiter(uc[iii0 + is * HS_DNX + js * HS_DNY + ks * HS_DNZ] - u0,
-												u0 - uc[iii0 - is * HS_DNX - js * HS_DNY - ks * HS_DNZ]);
-										auto &uf = Uf[f][iii0][ir][jr][kr];
-										uf = u0;
-										uf += (9.0 / 64.0) * (s_x + s_y + s_z);
-										uf += (3.0 / 64.0) * (s_xy + s_yz + s_xz);
-										uf += (1.0 / 64.0) * s_xyz;
-									}
-								}
-							}
-						}
-					}
+	for (const int iii0 : amr_coarse_list) {
+		const int i0 = iii0 / HS_DNX;
+		const int j0 = (iii0 / HS_DNY) % HS_NX;
+		const int k0 = iii0 % HS_NX;
+
+		/* Limited trilinear prolongation, all eight children at once */
+		for (int f = f0; f < f1; f++) {
+			const auto *uc = Ushad[f].data() + iii0;
+			const double u0 = uc[0];
+			std::array<oct_array, NDIFF> s;
+			for (int d = 0; d < NDIFF; d++) {
+				const auto &off = amr_stencil.offset[d];
+#pragma GCC ivdep
+				for (int c = 0; c < NCHILD; c++) {
+					s[d][c] = limiter(uc[off[c]] - u0, u0 - uc[-off[c]]);
 				}
 			}
+			auto &uf = Uf[f];
+#pragma GCC ivdep
+			for (int c = 0; c < NCHILD; c++) {
+				uf[c] = u0;
+				uf[c] += (9.0 / 64.0) * (s[0][c] + s[1][c] + s[2][c]);
+				uf[c] += (3.0 / 64.0) * (s[3][c] + s[4][c] + s[5][c]);
+				uf[c] += (1.0 / 64.0) * s[6][c];
+			}
 		}
-	}
 
-	if (!energy_only) {
-		for (int i0 = 1; i0 < HS_NX - 1; i0++) {
-			for (int j0 = 1; j0 < HS_NX - 1; j0++) {
-				for (int k0 = 1; k0 < HS_NX - 1; k0++) {
-					const int iii0 = hSindex(i0, j0, k0);
-					if (is_coarse[iii0]) {
-						for (int ir = 0; ir < 2; ir++) {
-							for (int jr = 0; jr < 2; jr++) {
-								for (int kr = 0; kr < 2; kr++) {
-									const auto i1 = 2 * i0 - H_BW + ir;
-									const auto j1 = 2 * j0 - H_BW + jr;
-									const auto k1 = 2 * k0 - H_BW + kr;
-									const auto x = (i1) * dx + xmin[XDIM];
-									const auto y = (j1) * dx + xmin[YDIM];
-									const auto z = (k1) * dx + xmin[ZDIM];
-									Uf[lx_i][iii0][ir][jr][kr] -= y * Uf[sz_i][iii0][ir][jr][kr] - z * Uf[sy_i][iii0][ir][jr][kr];
-									Uf[ly_i][iii0][ir][jr][kr] += x * Uf[sz_i][iii0][ir][jr][kr] - z * Uf[sx_i][iii0][ir][jr][kr];
-									Uf[lz_i][iii0][ir][jr][kr] -= x * Uf[sy_i][iii0][ir][jr][kr] - y * Uf[sx_i][iii0][ir][jr][kr];
-								}
-							}
-						}
-						double zx = 0, zy = 0, zz = 0, rho = 0;
-						for (int ir = 0; ir < 2; ir++) {
-							for (int jr = 0; jr < 2; jr++) {
-								for (int kr = 0; kr < 2; kr++) {
-									zx += Uf[lx_i][iii0][ir][jr][kr] / 8.0;
-									zy += Uf[ly_i][iii0][ir][jr][kr] / 8.0;
-									zz += Uf[lz_i][iii0][ir][jr][kr] / 8.0;
-									//			rho += Uf[rho_i][iii0][ir][jr][kr] / 8.0;
-								}
-							}
-						}
-						for (int ir = 0; ir < 2; ir++) {
-							for (int jr = 0; jr < 2; jr++) {
-								for (int kr = 0; kr < 2; kr++) {
-									//					const auto factor = Uf[rho_i][iii0][ir][jr][kr] / rho;
-									const auto factor = 1.0;
-									Uf[lx_i][iii0][ir][jr][kr] = zx * factor;
-									Uf[ly_i][iii0][ir][jr][kr] = zy * factor;
-									Uf[lz_i][iii0][ir][jr][kr] = zz * factor;
-								}
-							}
-						}
-						for (int ir = 0; ir < 2; ir++) {
-							for (int jr = 0; jr < 2; jr++) {
-								for (int kr = 0; kr < 2; kr++) {
-									const auto i1 = 2 * i0 - H_BW + ir;
-									const auto j1 = 2 * j0 - H_BW + jr;
-									const auto k1 = 2 * k0 - H_BW + kr;
-									const auto x = (i1) * dx + xmin[XDIM];
-									const auto y = (j1) * dx + xmin[YDIM];
-									const auto z = (k1) * dx + xmin[ZDIM];
-									Uf[lx_i][iii0][ir][jr][kr] += y * Uf[sz_i][iii0][ir][jr][kr] - z * Uf[sy_i][iii0][ir][jr][kr];
-									Uf[ly_i][iii0][ir][jr][kr] -= x * Uf[sz_i][iii0][ir][jr][kr] - z * Uf[sx_i][iii0][ir][jr][kr];
-									Uf[lz_i][iii0][ir][jr][kr] += x * Uf[sy_i][iii0][ir][jr][kr] - y * Uf[sx_i][iii0][ir][jr][kr];
-								}
-							}
-						}
-					}
-				}
+		/* Replace the children's spin with the average of their total angular momentum, same cell pass */
+		if (!energy_only) {
+			oct_array x, y, z;
+			for (int c = 0; c < NCHILD; c++) {
+				x[c] = (2 * i0 - H_BW + c / 4) * dx + xmin[XDIM];
+				y[c] = (2 * j0 - H_BW + (c / 2) % 2) * dx + xmin[YDIM];
+				z[c] = (2 * k0 - H_BW + c % 2) * dx + xmin[ZDIM];
+			}
+			auto &lx = Uf[lx_i];
+			auto &ly = Uf[ly_i];
+			auto &lz = Uf[lz_i];
+			const auto &sx = Uf[sx_i];
+			const auto &sy = Uf[sy_i];
+			const auto &sz = Uf[sz_i];
+			double zx = 0, zy = 0, zz = 0;
+#pragma GCC ivdep
+			for (int c = 0; c < NCHILD; c++) {
+				lx[c] -= y[c] * sz[c] - z[c] * sy[c];
+				ly[c] += x[c] * sz[c] - z[c] * sx[c];
+				lz[c] -= x[c] * sy[c] - y[c] * sx[c];
+			}
+			for (int c = 0; c < NCHILD; c++) {
+				zx += lx[c] / 8.0;
+				zy += ly[c] / 8.0;
+				zz += lz[c] / 8.0;
+			}
+#pragma GCC ivdep
+			for (int c = 0; c < NCHILD; c++) {
+				lx[c] = zx + (y[c] * sz[c] - z[c] * sy[c]);
+				ly[c] = zy - (x[c] * sz[c] - z[c] * sx[c]);
+				lz[c] = zz + (x[c] * sy[c] - y[c] * sx[c]);
 			}
 		}
-	}
-	for (int f = 0; f < opts().n_fields; f++) {
-		if (!energy_only || f == egas_i) {
-			for (int i = 0; i < H_NX; i++) {
-				for (int j = 0; j < H_NX; j++) {
-					for (int k = 0; k < H_NX; k++) {
-						const int i0 = (i + H_BW) / 2;
-						const int j0 = (j + H_BW) / 2;
-						const int k0 = (k + H_BW) / 2;
-						const int iii0 = hSindex(i0, j0, k0);
-						const int iiir = hindex(i, j, k);
-						if (is_coarse[iii0]) {
-							int ir, jr, kr;
-							if constexpr (H_BW % 2 == 0) {
-								ir = i % 2;
-								jr = j % 2;
-								kr = k % 2;
-							} else {
-								ir = 1 - (i % 2);
-								jr = 1 - (j % 2);
-								kr = 1 - (k % 2);
-							}
-							U[f][iiir] = Uf[f][iii0][ir][jr][kr];
-						}
-					}
-				}
+
+		/* Scatter the children that lie inside the fine grid (ghost zones included) */
+		for (int c = 0; c < NCHILD; c++) {
+			const int i = 2 * i0 - H_BW + c / 4;
+			const int j = 2 * j0 - H_BW + (c / 2) % 2;
+			const int k = 2 * k0 - H_BW + c % 2;
+			if (i < 0 || i >= H_NX || j < 0 || j >= H_NX || k < 0 || k >= H_NX) {
+				continue;
+			}
+			const int iiir = hindex(i, j, k);
+			for (int f = f0; f < f1; f++) {
+				U[f][iiir] = Uf[f][c];
 			}
 		}
 	}
@@ -259,4 +270,5 @@ void grid::clear_amr() {
 	PROFILE();
 	std::fill(is_coarse.begin(), is_coarse.end(), 0);
 	std::fill(has_coarse.begin(), has_coarse.end(), 0);
+	std::fill(amr_dirs.begin(), amr_dirs.end(), 0);
 }
@@ -19,6 +19,7 @@
 
 #include <hpx/include/parallel_for_loop.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <utility>
@@ -1506,6 +1507,52 @@ expansion_pass_type grid::compute_expansions(gsolve_type type, const expansion_p
 	return exp_ret;
 }
 
+bool grid::fmm_source_changed(gsolve_type type, bool full_solve) {
+	// cell masses (or their time derivatives) of the multipoles computed last
+	std::vector<real> source(INX * INX * INX);
+	if (is_leaf) {
+		std::copy(mon_ptr->begin(), mon_ptr->begin() + source.size(), source.begin());
+	} else {
+		for (std::size_t i = 0; i != source.size(); ++i) {
+			source[i] = (*M_ptr)[i]();
+		}
+	}
+	auto &ref = fmm_source_ref[type];
+	if (full_solve || ref.size() != source.size()) {
+		ref = std::move(source);
+		return true;
+	}
+	real delta = 0.0;
+	real norm = 0.0;
+	for (std::size_t i = 0; i != source.size(); ++i) {
+		delta += std::abs(source[i] - ref[i]);
+		norm += std::abs(ref[i]);
+	}
+	return delta > opts().fmm_tolerance * norm;
+}
+
+void grid::store_fmm_interactions(gsolve_type type) {
+	fmm_L_cache[type] = L;
+	fmm_L_c_cache[type] = L_c;
+}
+
+bool grid::restore_fmm_interactions(gsolve_type type) {
+	if (fmm_L_cache[type].size() != L.size() || fmm_L_c_cache[type].size() != L_c.size()) {
+		return false;
+	}
+	std::copy(fmm_L_cache[type].begin(), fmm_L_cache[type].end(), L.begin());
+	std::copy(fmm_L_c_cache[type].begin(), fmm_L_c_cache[type].end(), L_c.begin());
+	return true;
+}
+
+void grid::clear_fmm_cache() {
+	for (integer type = 0; type != 2; ++type) {
+		fmm_source_ref[type].clear();
+		fmm_L_cache[type].clear();
+		fmm_L_c_cache[type].clear();
+	}
+}
+
 multipole_pass_type grid::compute_multipoles(gsolve_type type, const multipole_pass_type *child_poles) {
 	PROFILE();
 
@@ -1547,8 +1594,10 @@ multipole_pass_type grid::compute_multipoles(gsolve_type type, const multipole_p
 	multipole_pass_type mret;
 	if (!is_root) {
 		mret.first.resize(INX * INX * INX / NCHILD);
-		mret.second.resize(INX * INX * INX / NCHILD);
-	} else {
+		// the parent only needs the centers of mass for RHO
+		if (type == RHO) {
+			mret.second.resize(INX * INX * INX / NCHILD);
+		}
 	}
 	taylor<4, real> MM;
 	integer index = 0;
@@ -1658,7 +1707,9 @@ multipole_pass_type grid::compute_multipoles(gsolve_type type, const multipole_p
 					if (!is_root && (lev == 1)) {
 
 						mret.first[index] = MM;
-						mret.second[index] = (*(com_ptr[lev]))[iiip];
+						if (type == RHO) {
+							mret.second[index] = (*(com_ptr[lev]))[iiip];
+						}
 						++index;
 
 					}
@@ -23,8 +23,6 @@ namespace hpx {
 using mutex = hpx::lcos::local::spinlock;
 }
 
-std::vector<std::vector<real>>& TLS_V();
-
 #include <unordered_map>
 
 
@@ -18,6 +18,8 @@
 #include "octotiger/util.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <mutex>
@@ -452,6 +454,19 @@ real grid::scf_update(real com, real omega, real c1, real c2, real c1_x, real c2
 
 
 
+/* Aitken delta-squared extrapolation of the last three iterates of an SCF parameter.  *
+ * Only applied while the sequence converges monotonically, otherwise the newest value *
+ * is returned unchanged.                                                              */
+static real aitken_extrapolate(const std::array<real, 3>& x) {
+	const real d0 = x[1] - x[0];
+	const real d1 = x[2] - x[1];
+	const real den = d1 - d0;
+	if (d0 * d1 <= 0.0 || std::abs(d1) >= std::abs(d0) || den == 0.0) {
+		return x[2];
+	}
+	return x[2] - d1 * d1 / den;
+}
+
 void node_server::run_scf(std::string const& data_dir) {
 	solve_gravity(false, false);
 	real omega = initial_params().omega;
@@ -460,7 +475,10 @@ void node_server::run_scf(std::string const& data_dir) {
 	grid::set_omega(omega);
 	printf("Starting SCF\n");
 	real l1_phi = 0.0, l2_phi, l3_phi;
-	for (integer i = 0; i != 100; ++i) {
+	const real tolerance = opts().scf_tolerance;
+	std::array<std::array<real, 3>, 3> history;
+	real last_omega = omega, last_d01 = 0.0, last_d02 = 0.0;
+	for (integer i = 0; i != opts().scf_max_iterations; ++i) {
 //		profiler_output(stdout);
 		char buffer[33];    // 21 bytes for int (max) + some leeway
 		sprintf(buffer, "X.scf.%i", int(i));
@@ -468,7 +486,7 @@ void node_server::run_scf(std::string const& data_dir) {
 		//	set_omega_and_pivot();
 		if (i % opts().scf_output_frequency == 0) {
 			if (!opts().disable_output) {
-				output_all(this, buffer, i,i == 100 || i == 0);
+				output_all(this, buffer, i,i == opts().scf_max_iterations || i == 0);
 			}
 		}
 		auto diags = diagnostics();
@@ -492,7 +510,13 @@ void node_server::run_scf(std::string const& data_dir) {
 		}
 		real spin_ratio = (j1 + j2) * INVERSE (jorb);
 		real this_m = (diags.m[0] + diags.m[1]);
-		solve_gravity(false, false);
+		/* rho_mult and rho_move barely change the density once the masses and the center  *
+		 * of mass have settled, so the potential of the previous iteration is kept then */
+		const real rho_change = std::max(std::max(std::abs(f0 - 1.0), std::abs(f1 - 1.0)),
+				std::abs(diags.grid_com[0]) * INVERSE(opts().xscale));
+		if (i == 0 || tolerance <= 0.0 || rho_change >= tolerance) {
+			solve_gravity(false, false);
+		}
 		auto axis = grid_ptr->find_axis();
 		auto loc = line_of_centers(axis);
 
@@ -501,6 +525,10 @@ void node_server::run_scf(std::string const& data_dir) {
 		real com = axis.second[0];
 		real new_omega;
 		new_omega = jorb0 * INVERSE( iorb );
+		history[0][i % 3] = new_omega;
+		if (opts().scf_aitken && i % 3 == 2) {
+			new_omega = aitken_extrapolate( { history[0][0], history[0][1], history[0][2] });
+		}
 		omega = new_omega;
 		std::pair<real, real> rho1_max;
 		std::pair<real, real> rho2_max;
@@ -523,13 +551,21 @@ void node_server::run_scf(std::string const& data_dir) {
 		l2_phi = l2_phi_pair.second;
 		l3_phi = l3_phi_pair.second;
 
+		real d01 = rho1 * f0;
+		real d02 = rho2 * f1;
+		history[1][i % 3] = d01;
+		history[2][i % 3] = d02;
+		if (opts().scf_aitken && i % 3 == 2) {
+			d01 = aitken_extrapolate( { history[1][0], history[1][1], history[1][2] });
+			d02 = aitken_extrapolate( { history[2][0], history[2][1], history[2][2] });
+		}
 		//	printf( "++++++++++++++++++++%e %e %e %e \n", rho1, rho2, c1_x, c2_x);
-		params.struct_eos2->set_d0(rho2 * f1);
+		params.struct_eos2->set_d0(d02);
 		if (scf_options::equal_struct_eos) {
 			//	printf( "%e %e \n", rho1, rho1*f0);
-			params.struct_eos1->set_d0_using_struct_eos(rho1 * f0, *(params.struct_eos2));
+			params.struct_eos1->set_d0_using_struct_eos(d01, *(params.struct_eos2));
 		} else {
-			params.struct_eos1->set_d0(rho1 * f0);
+			params.struct_eos1->set_d0(d01);
 		}
 		static real rhoc1 = 1.0e-3 * rho1;
 		if (opts().v1309) {
@@ -651,6 +687,15 @@ void node_server::run_scf(std::string const& data_dir) {
 		scf_update(com, omega, c_1, c_2, rho1_max.first, rho2_max.first, l1_x, *e1, *e2);
 		solve_gravity(false, false);
 
+		const real residual = std::max(std::abs(omega - last_omega) * INVERSE(std::abs(omega)),
+				std::max(std::abs(d01 - last_d01) * INVERSE(d01), std::abs(d02 - last_d02) * INVERSE(d02)));
+		last_omega = omega;
+		last_d01 = d01;
+		last_d02 = d02;
+		if (i > 0 && tolerance > 0.0 && residual < tolerance && rho_change < tolerance) {
+			printf("SCF converged after %i iterations (residual %e)\n", int(i + 1), residual);
+			break;
+		}
 	}
 	if (opts().radiation) {
 		if (opts().eos == WD) {
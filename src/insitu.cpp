@@ -0,0 +1,288 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "octotiger/insitu.hpp"
+#include "octotiger/grid.hpp"
+#include "octotiger/options.hpp"
+#include "octotiger/profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+std::vector<std::string> split_list(const std::string &str) {
+	std::vector<std::string> rc;
+	std::istringstream list(str);
+	std::string name;
+	while (std::getline(list, name, ',')) {
+		if (!name.empty()) {
+			rc.push_back(name);
+		}
+	}
+	return rc;
+}
+
+const char *const axis_names[NDIM] = { "x", "y", "z" };
+
+/* the two image axes of a projection along or a slice across axis d */
+integer image_axis_a(integer d) {
+	return d == XDIM ? YDIM : XDIM;
+}
+
+integer image_axis_b(integer d) {
+	return d == ZDIM ? YDIM : ZDIM;
+}
+
+void add_to(std::vector<real> &a, const std::vector<real> &b) {
+	if (a.empty()) {
+		a = b;
+	} else {
+		for (std::size_t i = 0; i != b.size(); ++i) {
+			a[i] += b[i];
+		}
+	}
+}
+
+struct pixel_weight {
+	integer pixel;
+	real w;
+};
+
+/* the pixels overlapped by each cell of a sub-grid along one axis, weighted by overlap over pixel size */
+std::array<std::vector<pixel_weight>, INX> pixel_weights(real xmin, real dx, const insitu_t &req) {
+	const real p = 2.0 * req.xmax / req.resolution;
+	std::array<std::vector<pixel_weight>, INX> rc;
+	for (integer i = 0; i != INX; ++i) {
+		const real lo = xmin + i * dx + req.xmax;
+		const real hi = lo + dx;
+		const integer p0 = std::max(integer(0), integer(lo / p));
+		const integer p1 = std::min(req.resolution - 1, integer(hi / p));
+		for (integer j = p0; j <= p1; ++j) {
+			const real w = (std::min(hi, (j + 1) * p) - std::max(lo, j * p)) / p;
+			if (w > 0.0) {
+				rc[i].push_back(pixel_weight { j, w });
+			}
+		}
+	}
+	return rc;
+}
+
+void write_image(FILE *fp, const insitu_t &req, const std::vector<real> &data, integer nimages) {
+	const integer res = req.resolution;
+	const real p = 2.0 * req.xmax / res;
+	const std::size_t size = res * res;
+	for (integer i = 0; i != res; ++i) {
+		for (integer j = 0; j != res; ++j) {
+			fprintf(fp, "%e %e", (i + 0.5) * p - req.xmax, (j + 0.5) * p - req.xmax);
+			for (integer n = 0; n != nimages; ++n) {
+				fprintf(fp, " %e", data[n * size + i * res + j]);
+			}
+			fprintf(fp, "\n");
+		}
+		fprintf(fp, "\n");
+	}
+}
+
+}
+
+insitu_t insitu_t::from_options() {
+	insitu_t rc;
+	const auto products = split_list(opts().insitu);
+	if (products.empty()) {
+		return rc;
+	}
+	for (const auto &name : split_list(opts().insitu_fields)) {
+		const auto f = grid::hydro_field_index(name);
+		if (f < 0) {
+			printf("--insitu_fields: %s is not a hydro field, skipping it\n", name.c_str());
+		} else {
+			rc.fields.push_back(f);
+			rc.field_names.push_back(name);
+		}
+	}
+	for (const auto &name : products) {
+		bool found = false;
+		for (integer d = 0; d != NDIM; ++d) {
+			if (name == std::string("projection_") + axis_names[d]) {
+				rc.projection[d] = found = true;
+			} else if (name == std::string("slice_") + axis_names[d]) {
+				rc.slice[d] = found = true;
+			}
+		}
+		if (name == "profile") {
+			rc.profile = found = true;
+		}
+		if (!found) {
+			printf("--insitu: unknown product %s, skipping it\n", name.c_str());
+		}
+	}
+	rc.resolution = opts().insitu_resolution;
+	rc.xmax = grid::get_scaling_factor();
+	return rc;
+}
+
+bool insitu_t::empty() const {
+	bool rc = !profile;
+	for (integer d = 0; d != NDIM; ++d) {
+		rc = rc && !projection[d] && !slice[d];
+	}
+	return rc;
+}
+
+insitu_t insitu_t::zeroed() const {
+	insitu_t rc;
+	rc.resolution = resolution;
+	rc.xmax = xmax;
+	rc.projection = projection;
+	rc.slice = slice;
+	rc.profile = profile;
+	rc.fields = fields;
+	rc.field_names = field_names;
+	const std::size_t size = resolution * resolution;
+	for (integer d = 0; d != NDIM; ++d) {
+		if (projection[d]) {
+			rc.projection_data[d].assign(size, 0.0);
+		}
+		if (slice[d]) {
+			rc.slice_data[d].assign(size * fields.size(), 0.0);
+		}
+	}
+	if (profile) {
+		rc.profile_data.assign(profile_bins() * (2 + fields.size()), 0.0);
+	}
+	return rc;
+}
+
+insitu_t& insitu_t::operator+=(const insitu_t &other) {
+	for (integer d = 0; d != NDIM; ++d) {
+		add_to(projection_data[d], other.projection_data[d]);
+		add_to(slice_data[d], other.slice_data[d]);
+	}
+	add_to(profile_data, other.profile_data);
+	return *this;
+}
+
+void insitu_t::write(integer cnt, real t) const {
+	const auto open = [cnt](const std::string &product) {
+		const auto fname = opts().data_dir + "insitu." + std::to_string(cnt) + "." + product + ".dat";
+		FILE *fp = fopen(fname.c_str(), "wt");
+		if (fp == nullptr) {
+			printf("unable to open %s\n", fname.c_str());
+		}
+		return fp;
+	};
+	for (integer d = 0; d != NDIM; ++d) {
+		const std::string a = axis_names[image_axis_a(d)];
+		const std::string b = axis_names[image_axis_b(d)];
+		if (projection[d]) {
+			if (FILE *fp = open(std::string("projection_") + axis_names[d])) {
+				fprintf(fp, "# t = %e, %s %s column_density\n", t, a.c_str(), b.c_str());
+				write_image(fp, *this, projection_data[d], 1);
+				fclose(fp);
+			}
+		}
+		if (slice[d] && !fields.empty()) {
+			if (FILE *fp = open(std::string("slice_") + axis_names[d])) {
+				fprintf(fp, "# t = %e, %s %s", t, a.c_str(), b.c_str());
+				for (const auto &name : field_names) {
+					fprintf(fp, " %s", name.c_str());
+				}
+				fprintf(fp, "\n");
+				write_image(fp, *this, slice_data[d], fields.size());
+				fclose(fp);
+			}
+		}
+	}
+	if (profile) {
+		if (FILE *fp = open("profile")) {
+			fprintf(fp, "# t = %e, r shell_mass", t);
+			for (const auto &name : field_names) {
+				fprintf(fp, " %s", name.c_str());
+			}
+			fprintf(fp, "\n");
+			const integer nbins = profile_bins();
+			const std::size_t stride = 2 + fields.size();
+			const real dr = xmax / nbins;
+			for (integer i = 0; i != nbins; ++i) {
+				const real *bin = profile_data.data() + i * stride;
+				fprintf(fp, "%e %e", (i + 0.5) * dr, bin[1]);
+				for (std::size_t f = 0; f != fields.size(); ++f) {
+					fprintf(fp, " %e", bin[0] > 0.0 ? bin[2 + f] / bin[0] : 0.0);
+				}
+				fprintf(fp, "\n");
+			}
+			fclose(fp);
+		}
+	}
+}
+
+void grid::insitu(insitu_t &rc) const {
+	PROFILE();
+	const integer res = rc.resolution;
+	const std::size_t size = res * res;
+	const real dV = dx * dx * dx;
+	std::array<std::array<std::vector<pixel_weight>, INX>, NDIM> weights;
+	for (integer d = 0; d != NDIM; ++d) {
+		weights[d] = pixel_weights(xmin[d], dx, rc);
+	}
+	/* the planes d = 0 lie on cell faces at every level, each slice takes the layer of cells just below */
+	std::array<integer, NDIM> slice_layer;
+	for (integer d = 0; d != NDIM; ++d) {
+		slice_layer[d] = -1;
+		for (integer i = 0; i != INX; ++i) {
+			if (std::abs(xmin[d] + (i + 1) * dx) < 0.5 * dx) {
+				slice_layer[d] = i;
+			}
+		}
+	}
+	const integer nbins = rc.profile_bins();
+	const std::size_t stride = 2 + rc.fields.size();
+	const real dr = rc.xmax / nbins;
+	std::array<integer, NDIM> idx;
+	for (idx[XDIM] = 0; idx[XDIM] != INX; ++idx[XDIM]) {
+		for (idx[YDIM] = 0; idx[YDIM] != INX; ++idx[YDIM]) {
+			for (idx[ZDIM] = 0; idx[ZDIM] != INX; ++idx[ZDIM]) {
+				const integer iii = hindex(idx[XDIM] + H_BW, idx[YDIM] + H_BW, idx[ZDIM] + H_BW);
+				for (integer d = 0; d != NDIM; ++d) {
+					const bool in_slice = rc.slice[d] && idx[d] == slice_layer[d];
+					if (!rc.projection[d] && !in_slice) {
+						continue;
+					}
+					const auto &wa = weights[image_axis_a(d)][idx[image_axis_a(d)]];
+					const auto &wb = weights[image_axis_b(d)][idx[image_axis_b(d)]];
+					for (const auto &a : wa) {
+						for (const auto &b : wb) {
+							const integer pixel = a.pixel * res + b.pixel;
+							const real w = a.w * b.w;
+							if (rc.projection[d]) {
+								rc.projection_data[d][pixel] += U[rho_i][iii] * dx * w;
+							}
+							if (in_slice) {
+								for (std::size_t f = 0; f != rc.fields.size(); ++f) {
+									rc.slice_data[d][f * size + pixel] += U[rc.fields[f]][iii] * w;
+								}
+							}
+						}
+					}
+				}
+				if (rc.profile) {
+					const real r = std::sqrt(X[XDIM][iii] * X[XDIM][iii] + X[YDIM][iii] * X[YDIM][iii] + X[ZDIM][iii] * X[ZDIM][iii]);
+					const integer i = r / dr;
+					if (i < nbins) {
+						real *bin = rc.profile_data.data() + i * stride;
+						bin[0] += dV;
+						bin[1] += U[rho_i][iii] * dV;
+						for (std::size_t f = 0; f != rc.fields.size(); ++f) {
+							bin[2 + f] += U[rc.fields[f]][iii] * dV;
+						}
+					}
+				}
+			}
+		}
+	}
+}
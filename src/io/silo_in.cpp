@@ -17,9 +17,14 @@
 #include <hpx/collectives/broadcast.hpp>
 #include <hpx/util/io_service_pool.hpp>
 
+#include <algorithm>
 #include <future>
 #include <mutex>
 #include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 static int version_;
@@ -65,6 +70,20 @@ static int timestamp;
 static int steps_elapsed;
 static DBfile *db_;
 static dir_map_type node_dir_;
+/* the data files this locality has read blocks from, kept open until load_close */
+static std::unordered_map<std::string, DBfile*> data_files_;
+
+static DBfile* open_data_file(const std::string &fname) {
+	auto &db = data_files_[fname];
+	if (db == nullptr) {
+		db = DBOpenReal(fname.c_str(), DB_UNKNOWN, DB_READ);
+		if (db == nullptr) {
+			printf("Unable to open SILO file %s\n", fname.c_str());
+			abort();
+		}
+	}
+	return db;
+}
 
 #define SILO_TEST(i) \
 	if( i != 0 ) printf( "SILO call failed at %i\n", __LINE__ );
@@ -147,6 +166,11 @@ void load_open(std::string fname, dir_map_type map) {
 
 void load_close() {
 	DBClose(db_);
+	for (auto &f : data_files_) {
+		DBClose(f.second);
+	}
+	data_files_.clear();
+	node_dir_.clear();
 }
 
 HPX_PLAIN_ACTION(load_close, load_close_action);
@@ -160,6 +184,7 @@ node_server::node_server(const node_location &loc) :
 
 	auto iter = node_dir_.find(loc.to_id());
 	assert(iter != node_dir_.end());
+	position = iter->second.position;
 
 	if (!iter->second.load) {
 //		printf("Creating %s on %i\n", loc.to_str().c_str(), int(hpx::get_locality_id()));
@@ -185,28 +210,31 @@ node_server::node_server(const node_location &loc) :
 		load.vars.resize(hydro_names.size());
 		load.outflows.resize(hydro_names.size());
 		hpx::threads::run_as_os_thread([&]() {
-			static std::mutex mtx;
-			std::lock_guard<std::mutex> lock(mtx);
+			std::lock_guard<std::mutex> lock(silo_mtx_);
 			const auto this_file = iter->second.filename;
-			DBfile *db = DBOpenReal(this_file.c_str(), DB_UNKNOWN, DB_READ);
-			if (db == NULL) {
-				printf("Unable to open SILO file %s\n", this_file.c_str());
-				abort();
-			}
+			DBfile *db = open_data_file(this_file);
 			const std::string suffix = oct_to_str(loc.to_id());
 			for (int f = 0; f != hydro_names.size(); f++) {
 				const auto this_name = suffix + std::string("/") + hydro_names[f]; /**/
 				auto var = DBGetQuadvar(db, this_name.c_str());
+				if (var == nullptr) {
+					printf("%s has no field %s, files written with --output_fields cannot be restarted from\n", this_file.c_str(), hydro_names[f].c_str());
+					abort();
+				}
 				load.nx = var->dims[0];
 				const int nvar = load.nx * load.nx * load.nx;
 				load.outflows[f].first = load.vars[f].first = hydro_names[f];
 				load.vars[f].second.resize(nvar);
 				read_silo_var<real> rd;
 				load.outflows[f].second = rd(db, outflow_name(this_name).c_str());
-				std::memcpy(load.vars[f].second.data(), var->vals[0], sizeof(real) * nvar);
+				if (var->datatype == DB_FLOAT) {
+					const auto *single = static_cast<const float*>(var->vals[0]);
+					std::copy(single, single + nvar, load.vars[f].second.begin());
+				} else {
+					std::memcpy(load.vars[f].second.data(), var->vals[0], sizeof(real) * nvar);
+				}
 				DBFreeQuadvar(var);
 			}
-			DBClose(db);
 		}).get();
 		is_refined = false;
 		for (integer f = 0; f < hydro_names.size(); f++) {
@@ -265,7 +293,6 @@ void load_data_from_silo(std::string fname, node_server *root_ptr, hpx::id_type
 	silo_epoch() = GET(hpx::threads::run_as_os_thread(read_silo_var<integer>(), db, "epoch"));
 	silo_epoch()++;std
 	::vector<node_location::node_id> node_list;
-	std::vector<integer> positions;
 	std::vector<hpx::future<void>> futs;
 	int node_count;
 	if (db != nullptr) {
@@ -277,21 +304,32 @@ void load_data_from_silo(std::string fname, node_server *root_ptr, hpx::id_type
 			const read_silo_var<integer> ri;
 			node_count = ri(db, "node_count");
 			node_list.resize(node_count);
-			positions.resize(node_count);
 			DBReadVar(db, "node_list", node_list.data());
-			DBReadVar(db, "node_positions", positions.data());
 		}).get();
 		GET(hpx::threads::run_as_os_thread(DBClose, db));
 		std::map<node_location::node_id, std::string> load_locs;
 		for (int i = 0; i < master_mesh->nblocks; i++) {
 			load_locs.insert(split_mesh_id(master_mesh->meshnames[i]));
 		}
-		for (int i = 0; i < node_list.size(); i++) {
+		/* The writer's positions and localities are ignored: the nodes are placed along the space filling *
+		 * curve over the localities of this run, the same way regrid_scatter would place them             */
+		std::vector<node_location> nodes;
+		nodes.reserve(node_list.size());
+		for (const auto id : node_list) {
+			nodes.emplace_back(id);
+		}
+		std::vector<int> order(nodes.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&nodes](int a, int b) {
+			return nodes[a].sfc_less(nodes[b]);
+		});
+		for (int p = 0; p < order.size(); p++) {
+			const int i = order[p];
 			node_entry_t entry;
-			entry.position = positions[i];
+			entry.position = p;
 			const auto tmp = load_locs.find(node_list[i]);
 			entry.load = bool(tmp != load_locs.end());
-			entry.locality_id = positions[i] * nprocs / positions.size();
+			entry.locality_id = integer(p) * nprocs / integer(order.size());
 			if (entry.load) {
 				entry.filename = tmp->second;
 			} else {
@@ -299,10 +337,26 @@ void load_data_from_silo(std::string fname, node_server *root_ptr, hpx::id_type
 			}
 			node_dir_[node_list[i]] = entry;
 		}
-		auto this_dir = std::move(node_dir_);
+		/* a locality only needs the nodes it owns and their children, which it creates */
+		std::vector<dir_map_type> dirs(nprocs);
+		for (const auto &entry : node_dir_) {
+			const node_location loc(entry.first);
+			dirs[entry.second.locality_id].insert(entry);
+			if (loc.level() > 0) {
+				const auto parent = node_dir_.find(loc.get_parent().to_id());
+				if (parent == node_dir_.end()) {
+					throw std::runtime_error("silo_in: node " + loc.to_str() + " has no parent in the node list of " + fname);
+				}
+				const auto parent_owner = parent->second.locality_id;
+				if (parent_owner != entry.second.locality_id) {
+					dirs[parent_owner].insert(entry);
+				}
+			}
+		}
+		node_dir_.clear();
 		for (int i = 0; i < nprocs; i++) {
 	//		printf("Sending LOAD OPEN to %i\n", i);
-			futs.push_back(hpx::async < load_open_action > (opts().all_localities[i], fname, this_dir));
+			futs.push_back(hpx::async < load_open_action > (opts().all_localities[i], fname, std::move(dirs[i])));
 		}
 		GET(hpx::threads::run_as_os_thread(DBFreeMultimesh, master_mesh));
 		for (auto &f : futs) {
@@ -4,6 +4,9 @@
 #include <ctime>
 #include <hpx/runtime/threads/run_as_os_thread.hpp>
 
+#include <sstream>
+#include <unordered_set>
+
 #include <sys/stat.h>
 
 static const auto &localities = options::all_localities;
@@ -16,6 +19,32 @@ struct write_silo_var {
 	}
 };
 
+/* --output_fields restricts the output to a subset of grid::get_field_names() */
+static bool is_output_field(const std::string &name) {
+	static const std::unordered_set<std::string> selected = []() {
+		std::unordered_set<std::string> rc;
+		std::istringstream list(opts().output_fields);
+		std::string name;
+		while (std::getline(list, name, ',')) {
+			if (!name.empty()) {
+				rc.insert(name);
+			}
+		}
+		return rc;
+	}();
+	return selected.empty() || selected.count(name);
+}
+
+static std::vector<std::string> output_field_names() {
+	std::vector<std::string> rc;
+	for (auto &name : grid::get_field_names()) {
+		if (is_output_field(name)) {
+			rc.push_back(std::move(name));
+		}
+	}
+	return rc;
+}
+
 struct node_list_t;
 
 void output_stage1(std::string fname, int cycle);
@@ -105,8 +134,17 @@ void output_stage1(std::string fname, int cycle) {
 				mesh_vars_t rc(loc);
 				const std::string suffix = oct_to_str(loc.to_id());
 				const grid &gridref = this_ptr->get_hydro_grid();
-				rc.vars = gridref.var_data();
-				rc.outflow = gridref.get_outflows();
+				auto vars = gridref.var_data();
+				auto outflow = gridref.get_outflows();
+				/* the hydro fields come first and line up with their outflows */
+				for (std::size_t m = 0; m != vars.size(); m++) {
+					if (is_output_field(vars[m].name())) {
+						if (m < outflow.size()) {
+							rc.outflow.push_back(std::move(outflow[m]));
+						}
+						rc.vars.push_back(std::move(vars[m]));
+					}
+				}
 				return std::move(rc);
 			}, i->first, i->second));
 		}
@@ -115,7 +153,7 @@ void output_stage1(std::string fname, int cycle) {
 
 node_list_t output_stage2(std::string fname, int cycle) {
 	const int this_id = hpx::get_locality_id();
-	const int nfields = grid::get_field_names().size();
+	const int nfields = output_field_names().size();
 	std::string this_fname = fname + std::string(".") + std::to_string(INX) + std::string(".silo");
 	all_mesh_vars.clear();
 	all_mesh_vars.reserve(futs_.size());
@@ -155,11 +193,14 @@ node_list_t output_stage2(std::string fname, int cycle) {
 
 void output_stage3(std::string fname, int cycle, int gn, int gb, int ge) {
 	const int this_id = hpx::get_locality_id();
-	const int nfields = grid::get_field_names().size();
+	const int nfields = output_field_names().size();
 	std::string this_fname = fname + ".silo.data/" + std::to_string(gn) + std::string(".silo");
 	double dtime = silo_output_rotation_time();
 	hpx::threads::run_as_os_thread([&this_fname, this_id, &dtime, gb, gn, ge](integer cycle) {
 		DBfile *db;
+		if (!opts().silo_compression.empty()) {
+			DBSetCompression(opts().silo_compression.c_str());
+		}
 		if (this_id == gb) {
 //			printf( "Create %s %i %i %i %i\n", this_fname.c_str(), this_id, gn, gb, ge);
 			db = DBCreateReal(this_fname.c_str(), DB_CLOBBER, DB_LOCAL, "Octo-tiger", SILO_DRIVER);
@@ -226,7 +267,15 @@ void output_stage3(std::string fname, int cycle, int gn, int gb, int ge) {
 //								printf( "%e\n", o(i));
 //							}
 					//				}
-					DBPutQuadvar1(db, o.name(), "quadmesh", o.data(), mesh_vars.var_dims.data(), ndim, nullptr, 0, DB_DOUBLE, DB_ZONECENT, optlist_var);
+					if (opts().silo_float) {
+						std::vector<float> single(o.size());
+						for (std::size_t i = 0; i != o.size(); i++) {
+							single[i] = o(i);
+						}
+						DBPutQuadvar1(db, o.name(), "quadmesh", single.data(), mesh_vars.var_dims.data(), ndim, nullptr, 0, DB_FLOAT, DB_ZONECENT, optlist_var);
+					} else {
+						DBPutQuadvar1(db, o.name(), "quadmesh", o.data(), mesh_vars.var_dims.data(), ndim, nullptr, 0, DB_DOUBLE, DB_ZONECENT, optlist_var);
+					}
 					count++;
 					DBFreeOptlist(optlist_var);
 				}
@@ -242,7 +291,7 @@ void output_stage3(std::string fname, int cycle, int gn, int gb, int ge) {
 }
 
 void output_stage4(std::string fname, int cycle) {
-	const int nfields = grid::get_field_names().size();
+	const int nfields = output_field_names().size();
 	std::string this_fname = fname + std::string(".silo");
 	double dtime = silo_output_rotation_time();
 	double rtime = silo_output_rotation_time();
@@ -262,7 +311,7 @@ void output_stage4(std::string fname, int cycle) {
 					node_locs.push_back(std::make_pair(node_list_.group_num[j], nloc));
 					j++;
 				}
-				const auto top_field_names = grid::get_field_names();
+				const auto top_field_names = output_field_names();
 				mesh_names.reserve(node_locs.size());
 				for (int f = 0; f < nfields; f++)
 				field_names[f].reserve(node_locs.size());
@@ -371,6 +420,7 @@ void output_stage4(std::string fname, int cycle) {
 				DBWrite(db, "atomic_number", opts().atomic_number.data(), &nspc, 1, db_type<real>::d);
 				fi(db, "node_count", integer(nnodes));
 				fi(db, "leaf_count", integer(node_list_.silo_leaves.size()));
+				fi(db, "field_subset", integer(!opts().output_fields.empty()));
 				write_silo_var<integer>()(db, "timestamp", timestamp);
 				write_silo_var<integer>()(db, "epoch", silo_epoch());
 				write_silo_var<integer>()(db, "locality_count", localities.size());
@@ -503,6 +553,10 @@ void output_all(node_server* root_ptr, std::string fname, int cycle, bool block)
 		printf("Skipping SILO output\n");
 		return;
 	}
+	if (output_field_names().empty()) {
+		printf("--output_fields=%s selects no field, skipping SILO output\n", opts().output_fields.c_str());
+		return;
+	}
 
 	std::string dir = fname + ".silo.data";
 	hpx::threads::run_as_os_thread([&]() {
@@ -547,7 +601,7 @@ void output_all(node_server* root_ptr, std::string fname, int cycle, bool block)
 		node_list_.positions.insert(node_list_.positions.end(), this_list.positions.begin(), this_list.positions.end());
 		node_list_.zone_count.insert(node_list_.zone_count.end(), this_list.zone_count.begin(),
 				this_list.zone_count.end());
-		const int nfields = grid::get_field_names().size();
+		const int nfields = output_field_names().size();
 		node_list_.extents.resize(nfields);
 		for (int f = 0; f < this_list.extents.size(); f++) {
 			node_list_.extents[f].insert(node_list_.extents[f].end(), this_list.extents[f].begin(),
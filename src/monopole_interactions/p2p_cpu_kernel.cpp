@@ -21,6 +21,76 @@ namespace octotiger {
 namespace fmm {
     namespace monopole_interactions {
 
+        namespace {
+            // offset on the coarse level between a cell of the given parity and its
+            // partner at distance s: floor((parity + s) / 2) - floor(parity / 2)
+            inline int coarse_offset(int parity, int s) {
+                const int q = parity + s;
+                return q >= 0 ? q / 2 : -((1 - q) / 2);
+            }
+
+            // Interaction lists per parity class (x-parity, y-parity of the first row) of
+            // the target cells. The lists only depend on the stencil and theta, so they are
+            // built once per worker and shared by all sub-grids.
+            const std::array<std::vector<p2p_stencil_entry>, 4>& interaction_lists(
+                const std::vector<bool>& stencil, const real theta_rec_squared) {
+                static thread_local std::array<std::vector<p2p_stencil_entry>, 4> lists;
+                static thread_local real lists_theta_rec_squared = -1.0;
+                static thread_local const std::vector<bool>* lists_stencil = nullptr;
+                if (lists_theta_rec_squared == theta_rec_squared && lists_stencil == &stencil) {
+                    return lists;
+                }
+                for (int px = 0; px < 2; px++) {
+                    for (int py = 0; py < 2; py++) {
+                        auto& list = lists[px * 2 + py];
+                        list.clear();
+                        for (int stencil_x = STENCIL_MIN; stencil_x <= STENCIL_MAX; stencil_x++) {
+                            const int x = stencil_x - STENCIL_MIN;
+                            const int cx = coarse_offset(px, stencil_x);
+                            for (int stencil_y = STENCIL_MIN; stencil_y <= STENCIL_MAX;
+                                 stencil_y++) {
+                                const int y = stencil_y - STENCIL_MIN;
+                                // the second row of the SIMD group has the opposite y-parity
+                                const int cy[2] = {coarse_offset(py, stencil_y),
+                                    coarse_offset(py ^ 1, stencil_y)};
+                                for (int stencil_z = STENCIL_MIN; stencil_z <= STENCIL_MAX;
+                                     stencil_z++) {
+                                    const int index = x * STENCIL_INX * STENCIL_INX +
+                                        y * STENCIL_INX + (stencil_z - STENCIL_MIN);
+                                    if (!stencil[index]) {
+                                        continue;
+                                    }
+                                    p2p_stencil_entry entry;
+                                    const int stride = static_cast<int>(PADDED_STRIDE);
+                                    entry.partner_offset =
+                                        (stencil_x * stride + stencil_y) * stride + stencil_z;
+                                    entry.stencil_index = index;
+                                    for (int row = 0; row < 2; row++) {
+                                        entry.lanes[row] = 0;
+                                        for (int pz = 0; pz < 2; pz++) {
+                                            const int cz = coarse_offset(pz, stencil_z);
+                                            const int distance_squared =
+                                                cx * cx + cy[row] * cy[row] + cz * cz;
+                                            if (theta_rec_squared >
+                                                static_cast<real>(distance_squared)) {
+                                                entry.lanes[row] |= 1 << pz;
+                                            }
+                                        }
+                                    }
+                                    if (entry.lanes[0] != 0 || entry.lanes[1] != 0) {
+                                        list.push_back(entry);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+                lists_theta_rec_squared = theta_rec_squared;
+                lists_stencil = &stencil;
+                return lists;
+            }
+        }
+
         p2p_cpu_kernel::p2p_cpu_kernel(std::vector<bool>& neighbor_empty)
           : neighbor_empty(neighbor_empty)
           , theta_rec_squared(sqr(1.0 / opts().theta))
@@ -34,50 +104,49 @@ namespace fmm {
             struct_of_array_data<expansion, real, 20, INNER_CELLS, SOA_PADDING>&
                 potential_expansions_SoA,
             const std::vector<bool>& stencil_masks, const std::vector<std::array<real, 4>>& four, real dx) {
-                for (size_t i0 = 0; i0 < INNER_CELLS_PER_DIRECTION; i0++) {
-                    for (size_t i1 = 0; i1 < INNER_CELLS_PER_DIRECTION; i1+=2) {
-                        // for (size_t i2 = 0; i2 < INNER_CELLS_PER_DIRECTION; i2++) {
-                        for (size_t i2 = 0; i2 < INNER_CELLS_PER_DIRECTION;
-                             i2 += m2m_vector::size()) {
-                            const multiindex<> cell_index(i0 + INNER_CELLS_PADDING_DEPTH,
-                                i1 + INNER_CELLS_PADDING_DEPTH, i2 + INNER_CELLS_PADDING_DEPTH);
-                            // BUG: indexing has to be done with uint32_t because of Vc limitation
-                            const int64_t cell_flat_index =
-                                to_flat_index_padded(cell_index);    // iii0...
-                            const multiindex<> cell_index_unpadded(i0, i1, i2);
-                            const int64_t cell_flat_index_unpadded =
-                                to_inner_flat_index_not_padded(cell_index_unpadded);
-
-                            // indices on coarser level (for outer stencil boundary)
-                            // implicitly broadcasts to vector
-                            multiindex<m2m_int_vector> cell_index_coarse(cell_index);
-                            for (size_t j = 0; j < m2m_int_vector::size(); j++) {
-                                cell_index_coarse.z[j] += j;
-                            }
-                            // note that this is the same for groups of 2x2x2 elements
-                            // -> maps to the same for some SIMD lanes
-                            cell_index_coarse.transform_coarse();
+            const auto& lists = interaction_lists(stencil_masks, theta_rec_squared[0]);
+
+            // lane_patterns[pz][lanes] is 1 in every lane that interacts, given the
+            // z-parity pz of the first lane and the lane bits of a stencil entry
+            m2m_vector lane_patterns[2][4];
+            for (size_t pz = 0; pz < 2; pz++) {
+                for (size_t lanes = 0; lanes < 4; lanes++) {
+                    for (size_t j = 0; j < m2m_vector::size(); j++) {
+                        lane_patterns[pz][lanes][j] = (lanes >> ((pz + j) & 1)) & 1 ? 1.0 : 0.0;
+                    }
+                }
+            }
 
-                            this->cell_interactions(local_expansions, potential_expansions_SoA,
-                                cell_index, cell_flat_index, cell_index_coarse, cell_index_unpadded,
-                                cell_flat_index_unpadded, stencil_masks, four, 0, dx);
-                        }
+            // parities are taken on the shifted indices used by transform_coarse
+            constexpr size_t parity_shift = INNER_CELLS_PADDING_DEPTH + INX;
+            for (size_t i0 = 0; i0 < INNER_CELLS_PER_DIRECTION; i0++) {
+                for (size_t i1 = 0; i1 < INNER_CELLS_PER_DIRECTION; i1 += 2) {
+                    const auto& list = lists[((i0 + parity_shift) & 1) * 2 + ((i1 + parity_shift) & 1)];
+                    for (size_t i2 = 0; i2 < INNER_CELLS_PER_DIRECTION;
+                         i2 += m2m_vector::size()) {
+                        const multiindex<> cell_index(i0 + INNER_CELLS_PADDING_DEPTH,
+                            i1 + INNER_CELLS_PADDING_DEPTH, i2 + INNER_CELLS_PADDING_DEPTH);
+                        const int64_t cell_flat_index = to_flat_index_padded(cell_index);    // iii0...
+                        const multiindex<> cell_index_unpadded(i0, i1, i2);
+                        const int64_t cell_flat_index_unpadded =
+                            to_inner_flat_index_not_padded(cell_index_unpadded);
+
+                        this->cell_interactions(local_expansions, potential_expansions_SoA,
+                            cell_flat_index, cell_flat_index_unpadded, list,
+                            lane_patterns[(i2 + parity_shift) & 1], four, dx);
                     }
                 }
             }
+        }
 
-        void p2p_cpu_kernel::cell_interactions(
-            std::vector<real>& mons,
+        void p2p_cpu_kernel::cell_interactions(const std::vector<real>& mons,
             struct_of_array_data<expansion, real, 20, INNER_CELLS,
                 SOA_PADDING>& __restrict__ potential_expansions_SoA,    // L
-            const multiindex<>& __restrict__ cell_index,
             const size_t cell_flat_index,    /// iii0
-            const multiindex<m2m_int_vector>& __restrict__ cell_index_coarse,
-            const multiindex<>& __restrict__ cell_index_unpadded,
             const size_t cell_flat_index_unpadded,
-            const std::vector<bool>& __restrict__ stencil,
-            const std::vector<std::array<real, 4>>& __restrict__ four_constants,
-            const size_t outer_stencil_index, real dx) {
+            const std::vector<p2p_stencil_entry>& interaction_list,
+            const m2m_vector (&lane_patterns)[4],
+            const std::vector<std::array<real, 4>>& __restrict__ four_constants, real dx) {
 
             const m2m_vector d_components[2] = {1.0 / dx, -1.0 / sqr(dx)};
             m2m_vector tmpstore1[4];
@@ -86,101 +155,36 @@ namespace fmm {
             tmpstore1[2] = potential_expansions_SoA.value<2>(cell_flat_index_unpadded);
             tmpstore1[3] = potential_expansions_SoA.value<3>(cell_flat_index_unpadded);
             m2m_vector tmpstore2[4];
-            tmpstore1[0] = potential_expansions_SoA.value<0>(cell_flat_index_unpadded);
-            tmpstore1[1] = potential_expansions_SoA.value<1>(cell_flat_index_unpadded);
-            tmpstore1[2] = potential_expansions_SoA.value<2>(cell_flat_index_unpadded);
-            tmpstore1[3] = potential_expansions_SoA.value<3>(cell_flat_index_unpadded);
-
-            bool data_changed = true;
-            size_t skipped = 0;
-            size_t calculated = 0;
-
-            for (int stencil_x = STENCIL_MIN; stencil_x <= STENCIL_MAX; stencil_x++) {
-                int x = stencil_x - STENCIL_MIN;
-                for (int stencil_y = STENCIL_MIN; stencil_y <= STENCIL_MAX; stencil_y++) {
-                    int y = stencil_y - STENCIL_MIN;
-                    for (int stencil_z = STENCIL_MIN; stencil_z <= STENCIL_MAX; stencil_z++) {
-                        const size_t index = x * STENCIL_INX * STENCIL_INX + y * STENCIL_INX + (stencil_z - STENCIL_MIN);
-                        if (!stencil[index]) {
-                            skipped++;
-                            continue;
-                        }
-                        calculated++;
-
-                        const multiindex<> stencil_element(stencil_x, stencil_y, stencil_z);
-                        const multiindex<> interaction_partner_index(cell_index.x + stencil_element.x,
-                                                                     cell_index.y + stencil_element.y,
-                                                                     cell_index.z + stencil_element.z);
-                        const multiindex<> interaction_partner_index2(cell_index.x + stencil_element.x,
-                                                                     cell_index.y +
-                        stencil_element.y + 1,
-                                                                     cell_index.z + stencil_element.z);
-
-                        const size_t interaction_partner_flat_index =
-                            to_flat_index_padded(interaction_partner_index);    // iii1n
-                        // if (vector_is_empty[interaction_partner_flat_index]) {
-                        //     continue;
-                        // }
-
-                        // implicitly broadcasts to vector
-                        multiindex<m2m_int_vector> interaction_partner_index_coarse(
-                            interaction_partner_index);
-                        multiindex<m2m_int_vector> interaction_partner_index_coarse2(
-                            interaction_partner_index2);
-                        interaction_partner_index_coarse.z += offset_vector;
-                        interaction_partner_index_coarse2.z += offset_vector;
-                        interaction_partner_index_coarse.transform_coarse();
-                        interaction_partner_index_coarse2.transform_coarse();
-
-                        m2m_int_vector theta_c_rec_squared_int = detail::distance_squared_reciprocal(
-                            cell_index_coarse, interaction_partner_index_coarse);
-                        m2m_int_vector theta_c_rec_squared_int2 = detail::distance_squared_reciprocal(
-                            cell_index_coarse, interaction_partner_index_coarse2);
-
-                        const m2m_vector theta_c_rec_squared =
-                            Vc::simd_cast<m2m_vector>(theta_c_rec_squared_int);
-                        const m2m_vector theta_c_rec_squared2 =
-                            Vc::simd_cast<m2m_vector>(theta_c_rec_squared_int2);
-
-                        const m2m_vector::mask_type mask = theta_rec_squared > theta_c_rec_squared;
-                        const m2m_vector::mask_type mask2 = theta_rec_squared > theta_c_rec_squared2;
-                        if (Vc::none_of(mask) && Vc::none_of(mask2)) {
-                            continue;
-                        }
-                        data_changed = true;
-                        m2m_vector monopole;
-                        Vc::where(mask, monopole) = m2m_vector(
-                            mons.data() + interaction_partner_flat_index);
-                        m2m_vector monopole2;
-                        Vc::where(mask2, monopole2) = m2m_vector(
-                            mons.data() + interaction_partner_flat_index + INX + 2 * STENCIL_MAX);
-
-                        const m2m_vector four[4] = {
-                            four_constants[index][0],
-                            four_constants[index][1],
-                            four_constants[index][2],
-                            four_constants[index][3]};
-
-                        compute_monopole_interaction<m2m_vector>(monopole, tmpstore1, four, d_components);
-                        compute_monopole_interaction<m2m_vector>(monopole2, tmpstore2, four, d_components);
-                    }
+            tmpstore2[0] = potential_expansions_SoA.value<0>(cell_flat_index_unpadded + INX);
+            tmpstore2[1] = potential_expansions_SoA.value<1>(cell_flat_index_unpadded + INX);
+            tmpstore2[2] = potential_expansions_SoA.value<2>(cell_flat_index_unpadded + INX);
+            tmpstore2[3] = potential_expansions_SoA.value<3>(cell_flat_index_unpadded + INX);
+
+            const real* partners = mons.data() + cell_flat_index;
+            for (const p2p_stencil_entry& entry : interaction_list) {
+                const real* partner = partners + entry.partner_offset;
+                const auto& constants = four_constants[entry.stencil_index];
+                const m2m_vector four[4] = {constants[0], constants[1], constants[2], constants[3]};
+                // lanes that do not interact are multiplied by zero instead of being masked
+                if (entry.lanes[0] != 0) {
+                    const m2m_vector monopole = m2m_vector(partner) * lane_patterns[entry.lanes[0]];
+                    compute_monopole_interaction<m2m_vector>(monopole, tmpstore1, four, d_components);
+                }
+                if (entry.lanes[1] != 0) {
+                    const m2m_vector monopole2 =
+                        m2m_vector(partner + PADDED_STRIDE) * lane_patterns[entry.lanes[1]];
+                    compute_monopole_interaction<m2m_vector>(monopole2, tmpstore2, four, d_components);
                 }
             }
 
-            if (data_changed) {
-                tmpstore1[0].store(potential_expansions_SoA.pointer<0>(cell_flat_index_unpadded));
-                tmpstore1[1].store(potential_expansions_SoA.pointer<1>(cell_flat_index_unpadded));
-                tmpstore1[2].store(potential_expansions_SoA.pointer<2>(cell_flat_index_unpadded));
-                tmpstore1[3].store(potential_expansions_SoA.pointer<3>(cell_flat_index_unpadded));
-                tmpstore2[0].store(
-                    potential_expansions_SoA.pointer<0>(cell_flat_index_unpadded + INX));
-                tmpstore2[1].store(
-                    potential_expansions_SoA.pointer<1>(cell_flat_index_unpadded + INX));
-                tmpstore2[2].store(
-                    potential_expansions_SoA.pointer<2>(cell_flat_index_unpadded + INX));
-                tmpstore2[3].store(
-                    potential_expansions_SoA.pointer<3>(cell_flat_index_unpadded + INX));
-            }
+            tmpstore1[0].store(potential_expansions_SoA.pointer<0>(cell_flat_index_unpadded));
+            tmpstore1[1].store(potential_expansions_SoA.pointer<1>(cell_flat_index_unpadded));
+            tmpstore1[2].store(potential_expansions_SoA.pointer<2>(cell_flat_index_unpadded));
+            tmpstore1[3].store(potential_expansions_SoA.pointer<3>(cell_flat_index_unpadded));
+            tmpstore2[0].store(potential_expansions_SoA.pointer<0>(cell_flat_index_unpadded + INX));
+            tmpstore2[1].store(potential_expansions_SoA.pointer<1>(cell_flat_index_unpadded + INX));
+            tmpstore2[2].store(potential_expansions_SoA.pointer<2>(cell_flat_index_unpadded + INX));
+            tmpstore2[3].store(potential_expansions_SoA.pointer<3>(cell_flat_index_unpadded + INX));
         }
     }    // namespace monopole_interactions
 }    // namespace fmm
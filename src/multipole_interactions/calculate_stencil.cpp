@@ -163,6 +163,27 @@ namespace fmm {
 
         }
 
+        std::vector<multiindex<>> calculate_root_stencil() {
+            // the root has no coarser level, so every pair of cells that is well separated
+            // on the root level interacts (same criterion as ilist_r in compute_ilist)
+            const real theta0 = opts().theta;
+            std::vector<multiindex<>> root_stencil;
+            for (int64_t j0 = 1 - INX; j0 < INX; ++j0) {
+                for (int64_t j1 = 1 - INX; j1 < INX; ++j1) {
+                    for (int64_t j2 = 1 - INX; j2 < INX; ++j2) {
+                        if (j0 == 0 && j1 == 0 && j2 == 0) {
+                            continue;
+                        }
+                        const real theta_f = detail::reciprocal_distance(0, 0, 0, j0, j1, j2);
+                        if (theta_f <= theta0) {
+                            root_stencil.emplace_back(j0, j1, j2);
+                        }
+                    }
+                }
+            }
+            return root_stencil;
+        }
+
     }    // namespace multipole_interactions
 }    // namespace fmm
 }    // namespace octotiger
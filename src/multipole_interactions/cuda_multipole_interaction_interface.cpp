@@ -32,9 +32,9 @@ namespace octotiger { namespace fmm { namespace multipole_interactions {
         kernel_scheduler::scheduler().init();
         // Check where we want to run this:
         int slot = kernel_scheduler::scheduler().get_launch_slot();
-        if (slot == -1 || m2m_type == interaction_kernel_type::OLD)
+        if (slot == -1 || m2m_type == interaction_kernel_type::OLD || grid_ptr->get_root())
         {
-            // Run fallback CPU implementation
+            // Run fallback CPU implementation (the root has its own kernel)
             multipole_interaction_interface::compute_multipole_interactions(
                 monopoles, M_ptr, com_ptr, neighbors, type, dx,
                 is_direction_empty, xbase);
@@ -15,12 +15,32 @@
 #include "octotiger/options.hpp"
 
 #include <cstddef>
+#include <initializer_list>
+#include <utility>
 #include <vector>
 
 namespace octotiger {
 namespace fmm {
     namespace multipole_interactions {
 
+        namespace {
+            template <typename soa_type, size_t... components>
+            inline void load_components(const soa_type& soa, const size_t flat_index,
+                m2m_vector* values, std::index_sequence<components...>) {
+                (void) std::initializer_list<int>{
+                    (values[components] = soa.template value<components>(flat_index), 0)...};
+            }
+
+            template <typename soa_type, size_t... components>
+            inline void add_and_store_components(soa_type& soa, const size_t flat_index,
+                m2m_vector* values, std::index_sequence<components...>) {
+                (void) std::initializer_list<int>{
+                    ((values[components] + soa.template value<components>(flat_index))
+                            .store(soa.template pointer<components>(flat_index)),
+                        0)...};
+            }
+        }
+
         multipole_cpu_kernel::multipole_cpu_kernel()
           : theta_rec_squared(sqr(1.0 / opts().theta)) {
             for (size_t i = 0; i < m2m_int_vector::size(); i++) {
@@ -986,6 +1006,83 @@ namespace fmm {
                     potential_expansions_SoA.pointer<19>(cell_flat_index_unpadded));
             }
         }
+
+        void multipole_cpu_kernel::apply_root_stencil(
+            const struct_of_array_data<expansion, real, 20, ROOT_ENTRIES, SOA_PADDING>&
+                root_expansions_SoA,
+            const struct_of_array_data<space_vector, real, 3, ROOT_ENTRIES, SOA_PADDING>&
+                root_center_of_masses_SoA,
+            struct_of_array_data<expansion, real, 20, INNER_CELLS, SOA_PADDING>&
+                potential_expansions_SoA,
+            struct_of_array_data<space_vector, real, 3, INNER_CELLS, SOA_PADDING>&
+                angular_corrections_SoA,
+            const std::vector<multiindex<>>& root_stencil, gsolve_type type) {
+            const int64_t lanes = m2m_vector::size();
+            for (int64_t i0 = 0; i0 < INNER_CELLS_PER_DIRECTION; i0++) {
+                for (int64_t i1 = 0; i1 < INNER_CELLS_PER_DIRECTION; i1++) {
+                    for (int64_t i2 = 0; i2 < INNER_CELLS_PER_DIRECTION; i2 += lanes) {
+                        const multiindex<> cell_index_unpadded(i0, i1, i2);
+                        const size_t cell_flat_index =
+                            to_root_flat_index_padded(cell_index_unpadded);
+                        const size_t cell_flat_index_unpadded =
+                            to_inner_flat_index_not_padded(cell_index_unpadded);
+
+                        m2m_vector X[3];
+                        load_components(root_center_of_masses_SoA, cell_flat_index, X,
+                            std::make_index_sequence<3>());
+                        m2m_vector m_cell[20];
+                        if (type == RHO) {
+                            load_components(root_expansions_SoA, cell_flat_index, m_cell,
+                                std::make_index_sequence<20>());
+                        }
+                        m2m_vector tmpstore[20];
+                        m2m_vector tmp_corrections[3];
+
+                        for (const multiindex<>& stencil_element : root_stencil) {
+                            const multiindex<> interaction_partner_index(i0 + stencil_element.x,
+                                i1 + stencil_element.y, i2 + stencil_element.z);
+                            // partners outside the root in x or y do not exist, lanes outside
+                            // in z load the zero padding and do not contribute
+                            if (interaction_partner_index.x < 0 ||
+                                interaction_partner_index.x >= INNER_CELLS_PER_DIRECTION ||
+                                interaction_partner_index.y < 0 ||
+                                interaction_partner_index.y >= INNER_CELLS_PER_DIRECTION ||
+                                interaction_partner_index.z <= -lanes ||
+                                interaction_partner_index.z >= INNER_CELLS_PER_DIRECTION) {
+                                continue;
+                            }
+                            const size_t interaction_partner_flat_index =
+                                to_root_flat_index_padded(interaction_partner_index);
+
+                            m2m_vector Y[3];
+                            load_components(root_center_of_masses_SoA,
+                                interaction_partner_flat_index, Y, std::make_index_sequence<3>());
+                            m2m_vector m_partner[20];
+                            load_components(root_expansions_SoA, interaction_partner_flat_index,
+                                m_partner, std::make_index_sequence<20>());
+
+                            if (type == RHO) {
+                                compute_kernel_rho(X, Y, m_partner, tmpstore, tmp_corrections,
+                                    m_cell, [](const m2m_vector& one, const m2m_vector& two)
+                                                -> m2m_vector { return Vc::max(one, two); });
+                            } else {
+                                compute_kernel_non_rho(X, Y, m_partner, tmpstore,
+                                    [](const m2m_vector& one, const m2m_vector& two)
+                                        -> m2m_vector { return Vc::max(one, two); });
+                            }
+                        }
+
+                        add_and_store_components(potential_expansions_SoA,
+                            cell_flat_index_unpadded, tmpstore, std::make_index_sequence<20>());
+                        if (type == RHO) {
+                            add_and_store_components(angular_corrections_SoA,
+                                cell_flat_index_unpadded, tmp_corrections,
+                                std::make_index_sequence<3>());
+                        }
+                    }
+                }
+            }
+        }
     }    // namespace multipole_interactions
 }    // namespace fmm
 }    // namespace octotiger
@@ -69,6 +69,12 @@ namespace fmm {
                     .second;
             return inner_stencil_masks_;
         }
+        std::vector<multiindex<>>& multipole_interaction_interface::root_stencil()
+        {
+            static thread_local std::vector<multiindex<>> root_stencil_ =
+                calculate_root_stencil();
+            return root_stencil_;
+        }
 
 
         multipole_interaction_interface::multipole_interaction_interface() {
@@ -86,6 +92,11 @@ namespace fmm {
                 cpu_launch_counter()++;
             else
                 cpu_launch_counter_non_rho()++;
+            if (grid_ptr->get_root() && m2m_type != interaction_kernel_type::OLD) {
+                this->type = type;
+                compute_root_interactions(M_ptr, com_ptr);
+                return;
+            }
             update_input(monopoles, M_ptr, com_ptr, neighbors, type, dx, xbase,
                 local_monopoles_staging_area, local_expansions_staging_area,
                 center_of_masses_staging_area);
@@ -131,6 +142,39 @@ namespace fmm {
                 }
             }
         }
+
+        void multipole_interaction_interface::compute_root_interactions(
+            std::vector<multipole>& M_ptr,
+            std::vector<std::shared_ptr<std::vector<space_vector>>>& com_ptr) {
+            std::vector<space_vector> const& com0 = *(com_ptr[0]);
+            // the root only exists once, no need for thread local staging areas
+            struct_of_array_data<expansion, real, 20, ROOT_ENTRIES, SOA_PADDING>
+                root_expansions_SoA;
+            struct_of_array_data<space_vector, real, 3, ROOT_ENTRIES, SOA_PADDING>
+                root_center_of_masses_SoA;
+            iterate_inner_cells_padded([&M_ptr, &com0, &root_expansions_SoA,
+                &root_center_of_masses_SoA](const multiindex<>& i, const size_t flat_index,
+                const multiindex<>& i_unpadded, const size_t flat_index_unpadded) {
+                const size_t root_flat_index = to_root_flat_index_padded(i_unpadded);
+                root_expansions_SoA.set_AoS_value(M_ptr[flat_index_unpadded], root_flat_index);
+                root_center_of_masses_SoA.set_AoS_value(
+                    com0[flat_index_unpadded], root_flat_index);
+            });
+
+            struct_of_array_data<expansion, real, 20, INNER_CELLS, SOA_PADDING>
+                potential_expansions_SoA;
+            struct_of_array_data<space_vector, real, 3, INNER_CELLS, SOA_PADDING>
+                angular_corrections_SoA;
+
+            multipole_cpu_kernel kernel;
+            kernel.apply_root_stencil(root_expansions_SoA, root_center_of_masses_SoA,
+                potential_expansions_SoA, angular_corrections_SoA, root_stencil(), type);
+
+            if (type == RHO) {
+                angular_corrections_SoA.to_non_SoA(grid_ptr->get_L_c());
+            }
+            potential_expansions_SoA.add_to_non_SoA(grid_ptr->get_L());
+        }
     }    // namespace multipole_interactions
 }    // namespace fmm
 }    // namespace octotiger
@@ -20,6 +20,7 @@
 #include <fstream>
 #include <iostream>
 #include <streambuf>
+#include <utility>
 #include <sys/stat.h>
 #if !defined(_MSC_VER)
 #include <unistd.h>
@@ -69,6 +70,16 @@ real node_server::get_rotation_count() const {
 	return current_time;
 }
 
+/* Boundary continuations keep the default launch policy and priority unless --numa_placement *
+ * asks for them to run on the domain of the sub-grid                                         */
+template<class T, class F>
+static future<void> then_on_domain(future<T> &&fut, std::int16_t domain, F &&f) {
+	if (opts().numa_placement) {
+		return fut.then(octotiger::numa::executor(domain, hpx::threads::thread_priority_normal), std::forward<F>(f));
+	}
+	return fut.then(std::forward<F>(f));
+}
+
 future<void> node_server::exchange_flux_corrections() {
 	const geo::octant ci = my_location.get_child_index();
 	constexpr auto full_set = geo::face::full_set();
@@ -99,7 +110,7 @@ future<void> node_server::exchange_flux_corrections() {
 	for (auto const &f : geo::face::full_set()) {
 		if (this->nieces[f] == +1) {
 			for (auto const &quadrant : geo::quadrant::full_set()) {
-				futs[index++] = niece_hydro_channels[f][quadrant].get_future().then(
+				futs[index++] = then_on_domain(niece_hydro_channels[f][quadrant].get_future(), numa_domain,
 				/*hpx::util::annotated_function(*/[this, f, quadrant](future<std::vector<real> > &&fdata) -> void {
 					const auto face_dim = f.get_dimension();
 					std::array<integer, NDIM> lb, ub;
@@ -192,7 +203,7 @@ void node_server::collect_hydro_boundaries(bool energy_only) {
 	integer index = 0;
 	for (auto const &dir : geo::direction::full_set()) {
 		if (!(neighbors[dir].empty() && my_location.level() == 0)) {
-			results[index++] = sibling_hydro_channels[dir].get_future(hcycle).then(
+			results[index++] = then_on_domain(sibling_hydro_channels[dir].get_future(hcycle), numa_domain,
 			/*hpx::util::annotated_function(*/[this, energy_only, dir](future<sibling_hydro_type> &&f) -> void {
 				auto &&tmp = GET(f);
 				if (!neighbors[dir].empty()) {
@@ -288,7 +299,7 @@ void node_server::static_initialize() {
 	}
 }
 
-void node_server::initialize(real t, real rt) {
+void node_server::initialize(real t, real rt, std::shared_ptr<grid> migrated) {
 	for (auto const &dir : geo::direction::full_set()) {
 		neighbor_signals[dir].signal();
 	}
@@ -296,6 +307,7 @@ void node_server::initialize(real t, real rt) {
 	step_num = 0;
 	refinement_flag = 0;
 	static_initialize();
+	numa_domain = -1;
 	is_refined = false;
 	neighbors.resize(geo::direction::count());
 	nieces.resize(NFACE);
@@ -305,7 +317,9 @@ void node_server::initialize(real t, real rt) {
 	for (auto &d : geo::dimension::full_set()) {
 		xmin[d] = grid::get_scaling_factor() * my_location.x_location(d);
 	}
-	if (current_time == ZERO) {
+	if (migrated != nullptr) {
+		grid_ptr = std::move(migrated);
+	} else if (current_time == ZERO) {
 		const auto p = get_problem();
 		grid_ptr = std::make_shared<grid>(p, dx, xmin);
 	} else {
@@ -338,7 +352,7 @@ node_server::node_server(const node_location &_my_location, integer _step_num, b
 		const std::array<integer, NCHILD> &_child_d, grid _grid, const std::vector<hpx::id_type> &_c, std::size_t _hcycle, std::size_t _rcycle,
 		std::size_t _gcycle, integer position_) {
 	my_location = _my_location;
-	initialize(_current_time, _rotational_time);
+	initialize(_current_time, _rotational_time, std::make_shared<grid>(std::move(_grid)));
 	position = position_;
 	hcycle = _hcycle;
 	gcycle = _gcycle;
@@ -347,8 +361,6 @@ node_server::node_server(const node_location &_my_location, integer _step_num, b
 	step_num = _step_num;
 	current_time = _current_time;
 	rotational_time = _rotational_time;
-//     grid test;
-	grid_ptr = std::make_shared<grid>(std::move(_grid));
 	if (is_refined) {
 		std::copy(_c.begin(), _c.end(), children.begin());
 	}
@@ -365,8 +377,6 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 		grid_ptr->egas_to_etot();
 	}
 	multipole_pass_type m_out;
-	m_out.first.resize(INX * INX * INX);
-	m_out.second.resize(INX * INX * INX);
 
 	for (auto const &dir : geo::direction::full_set()) {
 		if (!neighbors[dir].empty()) {
@@ -375,12 +385,17 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 	}
 
 	if (is_refined) {
+		// centers of mass only travel with RHO passes
+		m_out.first.resize(INX * INX * INX);
+		if (type == RHO) {
+			m_out.second.resize(INX * INX * INX);
+		}
 		std::array<future<void>, geo::octant::count()> futs;
 		integer index = 0;
 		for (auto &ci : geo::octant::full_set()) {
 			future<multipole_pass_type> m_in_future = child_gravity_channels[ci].get_future();
 
-			futs[index++] = m_in_future.then(/*hpx::util::annotated_function(*/[&m_out, ci](future<multipole_pass_type> &&fut) {
+			futs[index++] = m_in_future.then(/*hpx::util::annotated_function(*/[&m_out, ci, type](future<multipole_pass_type> &&fut) {
 				const integer x0 = ci.get_side(XDIM) * INX / 2;
 				const integer y0 = ci.get_side(YDIM) * INX / 2;
 				const integer z0 = ci.get_side(ZDIM) * INX / 2;
@@ -391,7 +406,9 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 							const integer ii = i * INX * INX / 4 + j * INX / 2 + k;
 							const integer io = (i + x0) * INX * INX + (j + y0) * INX + k + z0;
 							m_out.first[io] = m_in.first[ii];
-							m_out.second[io] = m_in.second[ii];
+							if (type == RHO) {
+								m_out.second[io] = m_in.second[ii];
+							}
 						}
 					}
 				}
@@ -407,6 +424,11 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 		parent.send_gravity_multipoles(std::move(m_out), my_location.get_child_index());
 	}
 
+	// lazy FMM: the interactions of a sub-grid are reused if neither its own sources nor those of its
+	// neighbors changed by more than fmm_tolerance since the last forced full solve
+	const bool lazy_fmm = opts().fmm_tolerance > 0.0;
+	const bool sources_changed = !lazy_fmm || grid_ptr->fmm_source_changed(type, step_num % opts().fmm_full_solve_interval == 0);
+
 	if (!aonly) {
 		std::vector<future<void>> send_futs;
 		for (auto const &dir : geo::direction::full_set()) {
@@ -416,11 +438,13 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 //             const auto gid = neighbors[dir].get_gid();
 				const bool is_local = neighbors[dir].is_local();
 				auto data = grid_ptr->get_gravity_boundary(dir, is_local);
+				data.changed = sources_changed;
 				if (is_local) {
 					data.local_semaphore = &neighbor_signals[dir];
 				} else {
 					neighbor_signals[dir].signal();
 					data.local_semaphore = nullptr;
+					data.reduced_precision = opts().fmm_float_boundaries;
 				}
 				neighbors[dir].send_gravity_boundary(std::move(data), ndir, is_monopole, gcycle);
 			}
@@ -430,17 +454,23 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 	/****************************************************************************/
 	// data managemenet for old and new version of interaction computation
 	// all neighbors and placeholder for yourself
+	// the boundaries are gathered before any interaction work: the interaction interfaces stage every
+	// direction into thread_local buffers, and a thread suspended between directions may resume elsewhere
 	bool contains_multipole = false;
+	bool neighbors_changed = false;
 	std::vector<neighbor_gravity_type> all_neighbor_interaction_data;
 	for (geo::direction const &dir : geo::direction::full_set()) {
 		if (!neighbors[dir].empty()) {
 			all_neighbor_interaction_data.push_back(neighbor_gravity_channels[dir].get_future(gcycle).get());
 			if (!all_neighbor_interaction_data[dir].is_monopole)
 				contains_multipole = true;
+			if (all_neighbor_interaction_data[dir].data.changed)
+				neighbors_changed = true;
 		} else {
 			all_neighbor_interaction_data.emplace_back();
 		}
 	}
+	const bool reuse_interactions = lazy_fmm && !sources_changed && !neighbors_changed && grid_ptr->restore_fmm_interactions(type);
 
 	std::array<bool, geo::direction::count()> is_direction_empty;
 	for (geo::direction const &dir : geo::direction::full_set()) {
@@ -454,8 +484,10 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 	bool new_style_enabled = true;
 	/***************************************************************************/
 	// new-style interaction calculation (both cannot be active at the same time)
-	//if (new_style_enabled && !grid_ptr->get_leaf() && !grid_ptr->get_root()) {
-	if (new_style_enabled && !grid_ptr->get_root()) {
+	if (reuse_interactions) {
+		// L and L_c have been restored from the last evaluation
+	} else if (new_style_enabled) {
+		// the root (no neighbors, no parent) is handled by a dedicated root kernel of the multipole interface
 
 		// Get all input structures we need as input
 		std::vector<multipole> &M_ptr = grid_ptr->get_M();
@@ -501,6 +533,10 @@ void node_server::compute_fmm(gsolve_type type, bool energy_account, bool aonly)
 		}
 	}
 
+	if (lazy_fmm && !reuse_interactions) {
+		grid_ptr->store_fmm_interactions(type);
+	}
+
 	/**************************************************************************/
 	// now that all boundary information has been processed, signal all non-empty neighbors
 	// note that this was done before during boundary calculations
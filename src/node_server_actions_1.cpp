@@ -185,6 +185,14 @@ future<void> node_client::regrid_scatter(integer a, integer b) const {
 void node_server::regrid_scatter(integer a_, integer total) {
 	position = a_;
 	refinement_flag = 0;
+	const auto domain = octotiger::numa::domain_of(position, total);
+	if (opts().numa_placement && domain != numa_domain) {
+		/* new, migrated or moved along the curve: re-allocate the grid on a worker of its domain */
+		numa_domain = domain;
+		GET(hpx::async(octotiger::numa::executor(numa_domain), [this]() {
+			grid_ptr->rehome();
+		}));
+	}
 	std::array<future<void>, geo::octant::count()> futs;
 	if (is_refined) {
 		integer a = a_;
@@ -220,6 +228,9 @@ void node_server::regrid_scatter(integer a_, integer total) {
 		}
 	}
 	clear_family();
+	if (opts().form_tree_directory) {
+		add_to_tree_directory();
+	}
 }
 
 node_count_type node_server::regrid(const hpx::id_type &root_gid, real omega, real new_floor, bool rb, bool grav_energy_comp) {
@@ -246,7 +257,7 @@ node_count_type node_server::regrid(const hpx::id_type &root_gid, real omega, re
 	assert(grid_ptr != nullptr);
 	tstart = timer.elapsed();
 	printf("forming tree connections\n");
-	a.amr_bnd = form_tree(hpx::unmanaged(root_gid));
+	a.amr_bnd = opts().form_tree_directory ? form_tree_from_directory() : form_tree(hpx::unmanaged(root_gid));
 	printf("%i amr boundaries\n", a.amr_bnd);
 	tstop = timer.elapsed();
 	printf("Formed tree in %f seconds\n", real(tstop - tstart));
@@ -8,6 +8,7 @@
 
 #include "octotiger/diagnostics.hpp"
 #include "octotiger/future.hpp"
+#include "octotiger/insitu.hpp"
 #include "octotiger/node_client.hpp"
 #include "octotiger/node_registry.hpp"
 #include "octotiger/node_server.hpp"
@@ -20,8 +21,13 @@
 #include <hpx/runtime/get_colocation_id.hpp>
 #include <hpx/serialization/list.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 using check_for_refinement_action_type = node_server::check_for_refinement_action;
 HPX_REGISTER_ACTION(check_for_refinement_action_type);
@@ -40,7 +46,6 @@ void node_server::check_for_refinement(real omega, real new_floor) {
 		}
 	}
 	node_registry::delete_(my_location);
-	bool rc = false;
 	std::array<future<void>, NCHILD + 1> futs;
 	for (integer i = 0; i != NCHILD + 1; ++i) {
 		futs[i] = hpx::make_ready_future();
@@ -54,16 +59,16 @@ void node_server::check_for_refinement(real omega, real new_floor) {
 	if (opts().hydro || opts().problem == AMR_TEST) {
 		all_hydro_bounds();
 	}
-	if (!rc) {
-		rc = grid_ptr->refine_me(my_location.level(), new_floor);
-	}
-	if (rc) {
-		if (refinement_flag++ == 0) {
-			if (!parent.empty()) {
-				futs[index++] = parent.force_nodes_to_exist(my_location.get_neighbors());
+	/* Flag this node in its own task so it is evaluated alongside the children's flagging */
+	futs[index++] = hpx::async([this, new_floor]() {
+		if (grid_ptr->refine_me(my_location.level(), new_floor)) {
+			if (refinement_flag++ == 0) {
+				if (!parent.empty()) {
+					GET(parent.force_nodes_to_exist(my_location.get_neighbors()));
+				}
 			}
 		}
-	}
+	});
 	for (auto& f : futs) {
 		GET(f);
 	}
@@ -136,11 +141,76 @@ future<hpx::id_type> node_server::copy_to_locality(const hpx::id_type& id) {
 	return rc;
 }
 
-using diagnostics_action_type = node_server::diagnostics_action;
-HPX_REGISTER_ACTION(diagnostics_action_type);
+static const auto& localities = options::all_localities;
 
-future<diagnostics_t> node_client::diagnostics(const diagnostics_t& d) const {
-	return hpx::async<typename node_server::diagnostics_action>(get_unmanaged_gid(), d);
+diagnostics_t locality_diagnostics(const diagnostics_t& diags);
+
+HPX_PLAIN_ACTION(locality_diagnostics, locality_diagnostics_action);
+
+/* Sums the diagnostics of every leaf on this locality, so that only one partial *
+ * result per locality takes part in the reduction at the root                  */
+diagnostics_t locality_diagnostics(const diagnostics_t& diags) {
+	std::vector<future<diagnostics_t>> futs;
+	futs.reserve(node_registry::size());
+	for (auto i = node_registry::begin(); i != node_registry::end(); ++i) {
+		auto* ptr = GET(i->second.get_ptr());
+		if (!ptr->refined()) {
+			futs.push_back(hpx::async([ptr, &diags]() {
+				return ptr->get_hydro_grid().diagnostics(diags);
+			}));
+		}
+	}
+	diagnostics_t sums;
+	for (auto& f : futs) {
+		sums += GET(f);
+	}
+	return sums;
+}
+
+insitu_t locality_insitu(const insitu_t& request);
+
+HPX_PLAIN_ACTION(locality_insitu, locality_insitu_action);
+
+/* Like locality_diagnostics, but the leaves deposit into one accumulator per worker thread *
+ * rather than one per leaf, since the images are large compared to a sub-grid             */
+insitu_t locality_insitu(const insitu_t& request) {
+	std::vector<node_server*> leaves;
+	for (auto i = node_registry::begin(); i != node_registry::end(); ++i) {
+		auto* ptr = GET(i->second.get_ptr());
+		if (!ptr->refined()) {
+			leaves.push_back(ptr);
+		}
+	}
+	const std::size_t nchunks = std::max(std::size_t(1), std::min(leaves.size(), std::size_t(hpx::get_os_thread_count())));
+	std::vector<future<insitu_t>> futs;
+	futs.reserve(nchunks);
+	for (std::size_t c = 0; c != nchunks; ++c) {
+		futs.push_back(hpx::async([c, nchunks, &leaves, &request]() {
+			auto rc = request.zeroed();
+			for (std::size_t i = c; i < leaves.size(); i += nchunks) {
+				leaves[i]->get_hydro_grid().insitu(rc);
+			}
+			return rc;
+		}));
+	}
+	auto sums = request.zeroed();
+	for (auto& f : futs) {
+		sums += GET(f);
+	}
+	return sums;
+}
+
+insitu_t node_server::insitu(const insitu_t& request) {
+	std::vector<future<insitu_t>> futs;
+	futs.reserve(localities.size());
+	for (auto const& locality : localities) {
+		futs.push_back(hpx::async<locality_insitu_action>(locality, request));
+	}
+	auto sums = request.zeroed();
+	for (auto& f : futs) {
+		sums += GET(f);
+	}
+	return sums;
 }
 
 using compare_analytic_action_type = node_server::compare_analytic_action;
@@ -231,11 +301,23 @@ diagnostics_t node_server::diagnostics() {
 		return diagnostics_t();
 	}
 
+	/* grid::diagnostics only reads the interior, so one boundary exchange up front *
+	 * leaves the ghost zones as consistent as the per-stage exchanges used to     */
+	enforce_bc();
 	diagnostics_t diags;
 	for (integer i = 1; i != (opts().problem == DWD ? 6 : 2); ++i) {
 //		printf( "%i\n", i );
 		diags.stage = i;
-		diags = diagnostics(diags).compute();
+		std::vector<future<diagnostics_t>> futs;
+		futs.reserve(localities.size());
+		for (auto const& locality : localities) {
+			futs.push_back(hpx::async<locality_diagnostics_action>(locality, diags));
+		}
+		diagnostics_t sums;
+		for (auto& f : futs) {
+			sums += GET(f);
+		}
+		diags = sums.compute();
 		if (opts().gravity) {
 			diags.grid_com = grid_ptr->center_of_mass();
 
@@ -286,40 +368,6 @@ diagnostics_t node_server::diagnostics() {
 	return diags;
 }
 
-diagnostics_t node_server::root_diagnostics(const diagnostics_t & diags) {
-	return diags;
-}
-
-diagnostics_t node_server::diagnostics(const diagnostics_t& diags) {
-	if (is_refined) {
-		auto rc = hpx::async([&]() {
-			return child_diagnostics(diags);
-		});
-		all_hydro_bounds();
-		auto diags = GET(rc);
-		return diags;
-	} else {
-		all_hydro_bounds();
-		return local_diagnostics(diags);
-	}
-}
-
-diagnostics_t node_server::child_diagnostics(const diagnostics_t& diags) {
-	diagnostics_t sums;
-	std::array<future<diagnostics_t>, NCHILD> futs;
-	integer index = 0;
-	for (integer ci = 0; ci != NCHILD; ++ci) {
-		futs[index++] = children[ci].diagnostics(diags);
-	}
-	auto child_sums = hpx::util::unwrap(futs);
-	return std::accumulate(child_sums.begin(), child_sums.end(), sums);
-}
-
-diagnostics_t node_server::local_diagnostics(const diagnostics_t& diags) {
-//	all_hydro_bounds();
-	return grid_ptr->diagnostics(diags);
-}
-
 using force_nodes_to_exist_action_type = node_server::force_nodes_to_exist_action;
 HPX_REGISTER_ACTION(force_nodes_to_exist_action_type);
 
@@ -362,7 +410,7 @@ void node_server::force_nodes_to_exist(std::vector<node_location>&& locs) {
 
 			bool found_match = false;
 			for (auto& di : geo::direction::full_set()) {
-				if (loc.is_child_of(my_location.get_neighbor(di)) && !neighbors[di].empty()) {
+				if (my_location.has_neighbor(di) && loc.is_child_of(my_location.get_neighbor(di)) && !neighbors[di].empty()) {
 					sibling_lists[di].push_back(loc);
 					found_match = true;
 					break;
@@ -408,6 +456,8 @@ bool operator!=(const node_client& nc, const hpx::id_type& id) {
 int node_server::form_tree(hpx::id_type self_gid, hpx::id_type parent_gid, std::vector<hpx::id_type> neighbor_gids) {
 	int amr_bnd = 0;
 
+	// neighbors and refinement may have changed, the next gravity solve has to be a full one
+	grid_ptr->clear_fmm_cache();
 	std::fill(nieces.begin(), nieces.end(), 0);
 	for (auto& dir : geo::direction::full_set()) {
 		neighbors[dir] = std::move(neighbor_gids[dir]);
@@ -440,8 +490,12 @@ int node_server::form_tree(hpx::id_type self_gid, hpx::id_type parent_gid, std::
 												hpx::unmanaged(children[other_child].get_gid()));
 									} else {
 										geo::direction dir = geo::direction((x / 2) + NDIM * ((y / 2) + NDIM * (z / 2)));
-										node_location parent_loc = my_location.get_neighbor(dir);
-										ref = neighbors[dir].get_child_client(parent_loc, other_child);
+										if (my_location.has_neighbor(dir)) {
+											node_location parent_loc = my_location.get_neighbor(dir);
+											ref = neighbors[dir].get_child_client(parent_loc, other_child);
+										} else {
+											ref = hpx::make_ready_future<hpx::id_type>(hpx::invalid_id);
+										}
 									}
 								}
 							}
@@ -495,6 +549,152 @@ int node_server::form_tree(hpx::id_type self_gid, hpx::id_type parent_gid, std::
 	return amr_bnd;
 }
 
+struct tree_directory_entry {
+	node_location::node_id location;
+	hpx::id_type gid;
+	bool refined;
+	template<class Arc>
+	void serialize(Arc& arc, unsigned) {
+		arc & location;
+		arc & gid;
+		arc & refined;
+	}
+};
+
+static std::vector<node_server*> directory_nodes_;
+static hpx::lcos::local::spinlock directory_mtx_;
+
+std::vector<tree_directory_entry> publish_tree_directory();
+int resolve_tree_directory(std::vector<tree_directory_entry>);
+
+HPX_PLAIN_ACTION(publish_tree_directory, publish_tree_directory_action);
+HPX_PLAIN_ACTION(resolve_tree_directory, resolve_tree_directory_action);
+
+std::vector<tree_directory_entry> publish_tree_directory() {
+	std::lock_guard<hpx::lcos::local::spinlock> lock(directory_mtx_);
+	std::vector<tree_directory_entry> entries;
+	entries.reserve(directory_nodes_.size());
+	for (auto* node : directory_nodes_) {
+		entries.push_back( { node->get_location().morton_key(), node->get_unmanaged_id(), node->refined() });
+	}
+	return entries;
+}
+
+int resolve_tree_directory(std::vector<tree_directory_entry> entries) {
+	node_server::tree_directory_type directory;
+	directory.reserve(entries.size());
+	for (auto& e : entries) {
+		directory.emplace(e.location, std::make_pair(std::move(e.gid), e.refined));
+	}
+	std::vector<node_server*> nodes;
+	{
+		std::lock_guard<hpx::lcos::local::spinlock> lock(directory_mtx_);
+		nodes = std::move(directory_nodes_);
+		directory_nodes_.clear();
+	}
+	std::vector<future<int>> futs;
+	futs.reserve(nodes.size());
+	for (auto* node : nodes) {
+		futs.push_back(hpx::async([node, &directory]() {
+			return node->link_from_directory(directory);
+		}));
+	}
+	int amr_bnd = 0;
+	for (auto& f : futs) {
+		amr_bnd += GET(f);
+	}
+	return amr_bnd;
+}
+
+void node_server::add_to_tree_directory() {
+	std::lock_guard<hpx::lcos::local::spinlock> lock(directory_mtx_);
+	directory_nodes_.push_back(this);
+}
+
+int node_server::form_tree_from_directory() {
+	std::vector<future<std::vector<tree_directory_entry>>> pfuts;
+	pfuts.reserve(localities.size());
+	for (auto& l : localities) {
+		pfuts.push_back(hpx::async<publish_tree_directory_action>(l));
+	}
+	std::vector<tree_directory_entry> entries;
+	for (auto& f : pfuts) {
+		auto these = GET(f);
+		entries.insert(entries.end(), std::make_move_iterator(these.begin()), std::make_move_iterator(these.end()));
+	}
+	std::vector<future<int>> rfuts;
+	rfuts.reserve(localities.size());
+	for (auto& l : localities) {
+		rfuts.push_back(hpx::async<resolve_tree_directory_action>(l, entries));
+	}
+	int amr_bnd = 0;
+	for (auto& f : rfuts) {
+		amr_bnd += GET(f);
+	}
+	return amr_bnd;
+}
+
+/* Sets exactly what form_tree and the set_child_aunt calls of the leaves set, looked up by location */
+int node_server::link_from_directory(const tree_directory_type& directory) {
+	const auto find = [&directory](const node_location& loc) -> const std::pair<hpx::id_type, bool>* {
+		const auto i = directory.find(loc.morton_key());
+		return i == directory.end() ? nullptr : &i->second;
+	};
+	const auto find_neighbor = [&find](const node_location& loc, const geo::direction& dir) -> const std::pair<hpx::id_type, bool>* {
+		return loc.has_neighbor(dir) ? find(loc.get_neighbor(dir)) : nullptr;
+	};
+	int amr_bnd = 0;
+
+	grid_ptr->clear_fmm_cache();
+	std::fill(nieces.begin(), nieces.end(), 0);
+	me = find(my_location)->first;
+	node_registry::add(my_location, me);
+	const bool has_parent = my_location.level() != 0;
+	parent = has_parent ? find(my_location.get_parent())->first : hpx::invalid_id;
+	for (auto& dir : geo::direction::full_set()) {
+		const auto* n = find_neighbor(my_location, dir);
+		neighbors[dir] = n ? n->first : hpx::invalid_id;
+	}
+	/* the aunt on a face is the leaf next to the parent, on the faces this node shares with the parent */
+	if (has_parent) {
+		const auto parent_loc = my_location.get_parent();
+		for (auto& f : geo::face::full_set()) {
+			if (my_location.get_child_side(f.get_dimension()) == f.get_side()) {
+				const auto* a = find_neighbor(parent_loc, f.to_direction());
+				if (a && !a->second) {
+					aunts[f] = a->first;
+				}
+			}
+		}
+	}
+	if (is_refined) {
+		amr_flags.resize(NCHILD);
+		for (auto& ci : geo::octant::full_set()) {
+			const auto child_loc = my_location.get_child(ci);
+			for (auto& dir : geo::direction::full_set()) {
+				amr_flags[ci][dir] = find_neighbor(child_loc, dir) == nullptr;
+				if (dir.is_face() && amr_flags[ci][dir]) {
+					amr_bnd++;
+				}
+			}
+		}
+	} else {
+		for (auto& f : geo::face::full_set()) {
+			const auto* n = find_neighbor(my_location, f.to_direction());
+			if (n) {
+#ifdef NIECE_BOOL
+				nieces[f] = n->second;
+#else
+				nieces[f] = n->second ? +1 : -1;
+#endif
+			} else {
+				nieces[f] = -2;
+			}
+		}
+	}
+	return amr_bnd;
+}
+
 using get_child_client_action_type = node_server::get_child_client_action;
 HPX_REGISTER_ACTION(get_child_client_action_type);
 
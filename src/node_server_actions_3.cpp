@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdio>
+#include <memory>
 
 using send_gravity_boundary_action_type = node_server::send_gravity_boundary_action;
 HPX_REGISTER_ACTION(send_gravity_boundary_action_type);
@@ -320,6 +321,9 @@ void node_server::execute_solver(bool scf, node_count_type ngrids) {
 	output_cnt = root_ptr->get_rotation_count() / output_dt;
 	printf("%e %e\n", root_ptr->get_rotation_count(), output_dt);
 
+	const auto insitu_request = insitu_t::from_options();
+	integer insitu_cnt = insitu_request.empty() ? 0 : integer(root_ptr->get_rotation_count() / opts().insitu_dt);
+
 	real bench_start, bench_stop;
 	while (current_time < opts().stop_time) {
 		timings::scope ts(timings_, timings::time_total);
@@ -345,6 +349,15 @@ void node_server::execute_solver(bool scf, node_count_type ngrids) {
 			++output_cnt;
 
 		}
+		if (!insitu_request.empty() && root_ptr->get_rotation_count() / opts().insitu_dt >= insitu_cnt) {
+			const auto products = std::make_shared<insitu_t>(insitu(insitu_request));
+			const integer cnt = insitu_cnt;
+			const real time = t;
+			hpx::threads::run_as_os_thread([products, cnt, time]() {
+				products->write(cnt, time);
+			});     // do not wait for it to finish
+			++insitu_cnt;
+		}
 		if (step_num == 0) {
 			bench_start = hpx::util::high_resolution_clock::now() / 1e9;
 		}
@@ -535,7 +548,7 @@ future<void> node_server::nonrefined_step() {
 
 	for (integer rk = 0; rk < NRK; ++rk) {
 
-		fut = fut.then(hpx::launch::async(hpx::threads::thread_priority_boost),
+		fut = fut.then(octotiger::numa::executor(numa_domain),
 		//hpx::util::annotated_function(
 				[rk, cfl0, this, dt_fut](future<void> f)
 				{
@@ -553,19 +566,29 @@ future<void> node_server::nonrefined_step() {
 						local_timestep_channels[NCHILD].set_value(dt_);
 					}
 					GET(fut_flux.then(
-									hpx::launch::async(hpx::threads::thread_priority_boost),
+									octotiger::numa::executor(numa_domain),
 									hpx::util::annotated_function(
 											[rk, this, dt_fut](future<void> f)
 											{
 												GET(f);        // propagate exceptions
 
-												grid_ptr->compute_sources(current_time, rotational_time);
-												grid_ptr->compute_dudt();
+												if (opts().rk_stage == FUSED) {
+													grid_ptr->compute_drho_dt();
+												} else {
+													grid_ptr->compute_sources(current_time, rotational_time);
+													grid_ptr->compute_dudt();
+												}
 												compute_fmm(DRHODT, false);
 												if (rk == 0) {
 													dt_ = GET(dt_fut);
 												}
-												grid_ptr->next_u(rk, current_time, dt_);
+												if (opts().rk_stage == FUSED) {
+													grid_ptr->next_u_fused(rk, current_time, rotational_time, dt_);
+												} else if (opts().rk_stage == VERIFY) {
+													grid_ptr->verify_next_u_fused(rk, current_time, rotational_time, dt_);
+												} else {
+													grid_ptr->next_u(rk, current_time, dt_);
+												}
 												compute_fmm(RHO, true);
 												rk == NRK - 1 ? energy_hydro_bounds() : all_hydro_bounds();
 											}, "node_server::nonrefined_step::compute_fmm"
@@ -621,7 +644,7 @@ future<real> node_server::local_step(integer steps) {
 			}
 		}
 
-		fut = fut.then(hpx::launch::async(hpx::threads::thread_priority_boost), [this, i, steps](future<void> fut) -> real
+		fut = fut.then(octotiger::numa::executor(numa_domain), [this, i, steps](future<void> fut) -> real
 		{
 			GET(fut);
 			auto time_start = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,48 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "octotiger/numa_placement.hpp"
+#include "octotiger/options.hpp"
+
+#include <hpx/include/runtime.hpp>
+
+#include <algorithm>
+
+namespace octotiger {
+namespace numa {
+
+std::size_t domain_count() {
+	static const std::size_t count = []() -> std::size_t {
+		if (!opts().numa_placement) {
+			return 1;
+		}
+		const std::size_t domains = hpx::threads::create_topology().get_number_of_numa_nodes();
+		return std::max(std::size_t(1), std::min(domains, hpx::get_os_thread_count()));
+	}();
+	return count;
+}
+
+std::int16_t domain_of(integer position, integer total) {
+	const integer domains = domain_count();
+	if (domains == 1 || total <= 0) {
+		return 0;
+	}
+	/* regrid_scatter sends position to locality position * nloc / total, the remainder is
+	 * the position inside that locality's range scaled to [0, total) */
+	const integer nloc = options::all_localities.size();
+	const integer offset = (position * nloc) % total;
+	return std::int16_t(offset * domains / total);
+}
+
+executor_type executor(std::int16_t domain, hpx::threads::thread_priority priority) {
+	if (domain < 0 || domain_count() == 1) {
+		return executor_type(priority);
+	}
+	return executor_type(priority, hpx::threads::thread_stacksize_default,
+			hpx::threads::thread_schedule_hint(hpx::threads::thread_schedule_hint_mode_numa, domain));
+}
+
+}
+}
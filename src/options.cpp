@@ -76,7 +76,11 @@ bool options::process_options(int argc, char *argv[]) {
 	("silo_offset_y", po::value<integer>(&(opts().silo_offset_y))->default_value(0), "")      //
 	("silo_offset_z", po::value<integer>(&(opts().silo_offset_z))->default_value(0), "")      //
 	("amrbnd_order", po::value<integer>(&(opts().amrbnd_order))->default_value(1), "amr boundary interpolation order")        //
+	("griddim", po::value<integer>(&(opts().griddim))->default_value(INX), "sub-grid size, runs octotiger-grid<N> if this binary was built for another size") //
 	("scf_output_frequency", po::value<integer>(&(opts().scf_output_frequency))->default_value(25), "Frequency of SCF output")        //
+	("scf_max_iterations", po::value<integer>(&(opts().scf_max_iterations))->default_value(100), "maximum number of SCF iterations")        //
+	("scf_tolerance", po::value<real>(&(opts().scf_tolerance))->default_value(0.0), "stop SCF once the relative change of omega and the central densities is below this (0 = always run scf_max_iterations)") //
+	("scf_aitken", po::value<bool>(&(opts().scf_aitken))->default_value(false), "Aitken extrapolation of omega and the central densities during SCF") //
 	("silo_num_groups", po::value<integer>(&(opts().silo_num_groups))->default_value(-1), "Number of SILO I/O groups")        //
 	("core_refine", po::value<bool>(&(opts().core_refine))->default_value(false), "refine cores by one more level")           //
 	("accretor_refine", po::value<integer>(&(opts().accretor_refine))->default_value(0), "number of extra levels for accretor") //
@@ -85,6 +89,11 @@ bool options::process_options(int argc, char *argv[]) {
 	("ngrids", po::value<integer>(&(opts().ngrids))->default_value(-1), "fix numbger of grids")                             //
 	("refinement_floor", po::value<real>(&(opts().refinement_floor))->default_value(1.0e-3), "density refinement floor")      //
 	("theta", po::value<real>(&(opts().theta))->default_value(0.5), "controls nearness determination for FMM, must be between 1/3 and 1/2")               //
+	("fmm_tolerance", po::value<real>(&(opts().fmm_tolerance))->default_value(0.0), "relative source change below which a sub-grid reuses its last FMM interactions (0 = always solve)") //
+	("fmm_full_solve_interval", po::value<integer>(&(opts().fmm_full_solve_interval))->default_value(16), "steps between forced full gravity solves when fmm_tolerance is set") //
+	("fmm_float_boundaries", po::value<bool>(&(opts().fmm_float_boundaries))->default_value(false), "send multipole gravity boundaries to other localities in single precision") //
+	("form_tree_directory", po::value<bool>(&(opts().form_tree_directory))->default_value(true), "link the tree after a regrid through per locality directories instead of per node queries") //
+	("numa_placement", po::value<bool>(&(opts().numa_placement))->default_value(false), "keep each sub-grid's memory and tasks on one NUMA domain of its locality") //
 	("eos", po::value<eos_type>(&(opts().eos))->default_value(IDEAL), "gas equation of state")                              //
 	("hydro", po::value<bool>(&(opts().hydro))->default_value(true), "hydro on/off")    //
 	("radiation", po::value<bool>(&(opts().radiation))->default_value(false), "radiation on/off")    //
@@ -96,7 +105,14 @@ bool options::process_options(int argc, char *argv[]) {
 	("bench", po::value<bool>(&(opts().bench))->default_value(false), "run benchmark") //
 	("datadir", po::value<std::string>(&(opts().data_dir))->default_value("./"), "directory for output") //
 	("output", po::value<std::string>(&(opts().output_filename))->default_value(""), "filename for output") //
+	("output_fields", po::value<std::string>(&(opts().output_fields))->default_value(""), "comma separated fields written to SILO (default all, a subset cannot be used for restart)") //
+	("silo_float", po::value<bool>(&(opts().silo_float))->default_value(false), "write SILO fields in single precision") //
+	("silo_compression", po::value<std::string>(&(opts().silo_compression))->default_value(""), "SILO compression string, e.g. \"METHOD=GZIP\" (default none)") //
 	("odt", po::value<real>(&(opts().output_dt))->default_value(1.0 / 100.0), "output frequency") //
+	("insitu", po::value<std::string>(&(opts().insitu))->default_value(""), "comma separated in-situ products: projection_x, projection_y, projection_z, slice_x, slice_y, slice_z, profile (default none)") //
+	("insitu_dt", po::value<real>(&(opts().insitu_dt))->default_value(1.0 / 1000.0), "in-situ output frequency, in orbits like odt") //
+	("insitu_fields", po::value<std::string>(&(opts().insitu_fields))->default_value("rho"), "comma separated hydro fields of the in-situ slices and profiles") //
+	("insitu_resolution", po::value<integer>(&(opts().insitu_resolution))->default_value(256), "pixels per side of the in-situ images, twice the number of profile bins") //
 	("dual_energy_sw1", po::value<real>(&(opts().dual_energy_sw1))->default_value(0.001), "dual energy switch 1") //
 	("dual_energy_sw2", po::value<real>(&(opts().dual_energy_sw2))->default_value(0.1), "dual energy switch 2") //
 	("hard_dt", po::value<real>(&(opts().hard_dt))->default_value(-1), "timestep size") //
@@ -113,10 +129,12 @@ bool options::process_options(int argc, char *argv[]) {
 	("multipole_kernel_type", po::value<interaction_kernel_type>(&(opts().m2m_kernel_type))->default_value(SOA_CPU), "boundary multipole-multipole kernel type") //
 	("p2p_kernel_type", po::value<interaction_kernel_type>(&(opts().p2p_kernel_type))->default_value(SOA_CPU), "boundary particle-particle kernel type")   //
 	("p2m_kernel_type", po::value<interaction_kernel_type>(&(opts().p2m_kernel_type))->default_value(SOA_CPU), "boundary particle-multipole kernel type") //
+	("rk_stage", po::value<rk_stage_type>(&(opts().rk_stage))->default_value(FUSED), "RK stage update of leaf grids: SEPARATE sweeps, FUSED single sweep, or VERIFY (run both, keep SEPARATE, report differences)") //
 	("cuda_streams_per_locality", po::value<size_t>(&(opts().cuda_streams_per_locality))->default_value(size_t(0)), "cuda streams per HPX locality") //
 	("cuda_streams_per_gpu", po::value<size_t>(&(opts().cuda_streams_per_gpu))->default_value(size_t(0)), "cuda streams per GPU (per locality)") //
 	("cuda_scheduling_threads", po::value<size_t>(&(opts().cuda_scheduling_threads))->default_value(size_t(0)),
 			"Number of worker threads per locality that mamage cuda streams") //
+	("scratch_size", po::value<size_t>(&(opts().scratch_size))->default_value(size_t(4)), "per worker scratch arena in MB (see the high water mark reported at exit)") //
 	("input_file", po::value<std::string>(&(opts().input_file))->default_value(""), "input file for test problems") //
 	("config_file", po::value<std::string>(&(opts().config_file))->default_value(""), "configuration file") //
 	("n_species", po::value<integer>(&(opts().n_species))->default_value(5), "number of mass species") //
@@ -167,12 +185,29 @@ bool options::process_options(int argc, char *argv[]) {
 		}
 		load_options_from_silo(opts().restart_filename);
 	}
+	if (opts().griddim != INX) {
+		std::cerr << "This binary was compiled for a sub-grid size of " << INX << ", not " << griddim << std::endl;
+		std::cerr << "Add " << griddim << " to the cmake parameter OCTOTIGER_EXTRA_GRIDDIMS to build octotiger-grid" << griddim << std::endl;
+		return false;
+	}
 	if (opts().theta < octotiger::fmm::THETA_FLOOR) {
 		std::cerr << "theta " << theta << " is too small since Octo-Tiger was compiled for a minimum of " 
 				  << octotiger::fmm::THETA_FLOOR << std::endl;
 		std::cerr << "Either increase theta or recompile with a new theta minimum using the cmake parameter OCTOTIGER_THETA_MINIMUM";
 		abort();
 	}
+	if (opts().fmm_tolerance > 0.0 && opts().fmm_full_solve_interval < 1) {
+		std::cerr << "fmm_full_solve_interval must be at least 1" << std::endl;
+		return false;
+	}
+	if (opts().scf_max_iterations < 1) {
+		std::cerr << "scf_max_iterations must be at least 1" << std::endl;
+		return false;
+	}
+	if (!opts().insitu.empty() && (opts().insitu_dt <= 0.0 || opts().insitu_resolution < 2)) {
+		std::cerr << "insitu needs a positive insitu_dt and an insitu_resolution of at least 2" << std::endl;
+		return false;
+	}
 	{
 #define SHOW( opt ) std::cout << std::string( #opt ) << " = " << to_string(opt) << '\n';
 		std::cout << "atomic_number=";
@@ -225,16 +260,27 @@ bool options::process_options(int argc, char *argv[]) {
 		SHOW(eos);
 		SHOW(entropy_driving_rate);
 		SHOW(entropy_driving_time);
+		SHOW(fmm_float_boundaries);
+		SHOW(fmm_full_solve_interval);
+		SHOW(fmm_tolerance);
+		SHOW(form_tree_directory);
 		SHOW(future_wait_time);
+		SHOW(griddim);
 		SHOW(hard_dt);
 		SHOW(hydro);
 		SHOW(input_file);
+		SHOW(insitu);
+		SHOW(insitu_dt);
+		SHOW(insitu_fields);
+		SHOW(insitu_resolution);
 		SHOW(m2m_kernel_type);
 		SHOW(max_level);
 		SHOW(n_species);
 		SHOW(ngrids);
+		SHOW(numa_placement);
 		SHOW(omega);
 		SHOW(output_dt);
+		SHOW(output_fields);
 		SHOW(output_filename);
 		SHOW(p2m_kernel_type);
 		SHOW(p2p_kernel_type);
@@ -243,9 +289,16 @@ bool options::process_options(int argc, char *argv[]) {
 		SHOW(radiation);
 		SHOW(refinement_floor);
 		SHOW(restart_filename);
+		SHOW(rk_stage);
 		SHOW(rotating_star_amr);
 		SHOW(rotating_star_x);
+		SHOW(scf_aitken);
+		SHOW(scf_max_iterations);
 		SHOW(scf_output_frequency);
+		SHOW(scf_tolerance);
+		SHOW(scratch_size);
+		SHOW(silo_compression);
+		SHOW(silo_float);
 		SHOW(silo_num_groups);
 		SHOW(stop_step);
 		SHOW(stop_time);
@@ -13,8 +13,11 @@
 
 #include <hpx/include/lcos.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 constexpr integer spc_ac_i = spc_i;
@@ -31,6 +34,7 @@ const real ssr0 = 1.0 / 3.0;
 init_func_type problem = nullptr;
 analytic_func_type analytic = nullptr;
 refine_test_type refine_test_function = refine_test;
+refine_pencil_test_type refine_pencil_test_function = refine_pencil_test;
 
 bool radiation_test_refine(integer level, integer max_level, real x, real y, real z, std::vector<real> U,
 		std::array<std::vector<real>, NDIM> const& dudx) {
@@ -197,11 +201,118 @@ bool refine_test_unigrid(integer level, integer max_level, real x, real y, real
 
 }
 
-void set_refine_test(const refine_test_type& rt) {
+/* Vectorized forms of the criteria above, evaluated over a whole pencil of cells.       *
+ * The density floor cascade  "rho > floor / 8^t for some t < test_level - level"  is      *
+ * monotone in t, so it reduces to a single threshold at t = test_level - level - 1.     */
+
+static real cascade_floor(real den_floor, integer level, integer test_level) {
+	return level < test_level ? std::ldexp(den_floor, -3 * int(test_level - level - 1)) : std::numeric_limits<real>::max();
+}
+
+bool refine_pencil_test(integer level, integer max_level, refine_pencil const& p) {
+	bool rc = false;
+	if (level < max_level / 2) {
+		const real dx = (opts().xscale / INX) / real(1 << level);
+		const real r2 = 100.0 * dx * dx - p.x * p.x - p.y * p.y;
+#pragma GCC ivdep
+		for (integer k = 0; k < p.n; k++) {
+			rc |= p.z[k] * p.z[k] < r2;
+		}
+		return rc;
+	}
+	const integer core_refine = opts().core_refine ? 1 : 0;
+	const integer donor_refine = opts().donor_refine;
+	const integer accretor_refine = opts().accretor_refine;
+	const integer min_test_level = std::max(integer(0), max_level - core_refine - donor_refine - accretor_refine);
+	std::array<real, MAX_LEVEL + 1> floor_of;
+	assert(max_level <= MAX_LEVEL);
+	for (integer tl = min_test_level; tl <= max_level; tl++) {
+		floor_of[tl] = cascade_floor(opts().refinement_floor, level, tl);
+	}
+	const real* rho = p.U[rho_i];
+	const real* ac = p.U[spc_ac_i];
+	const real* ae = p.U[spc_ae_i];
+	const real* dc = p.U[spc_dc_i];
+	const real* de = p.U[spc_de_i];
+#pragma GCC ivdep
+	for (integer k = 0; k < p.n; k++) {
+		const integer enuf_core = ac[k] + dc[k] > 0.25 * rho[k];
+		const integer majority_accretor = ae[k] + ac[k] > 0.5 * rho[k];
+		const integer majority_donor = de[k] + dc[k] > 0.5 * rho[k];
+		integer tl = max_level;
+		tl -= core_refine * (1 - enuf_core);
+		tl -= donor_refine * (1 - majority_donor);
+		tl -= accretor_refine * (1 - majority_accretor);
+		rc |= rho[k] > floor_of[std::max(tl, min_test_level)];
+	}
+	return rc;
+}
+
+bool refine_pencil_test_moving_star(integer level, integer max_level, refine_pencil const& p) {
+	integer test_level = max_level;
+	if (p.x > 0.0 && opts().rotating_star_amr) {
+		test_level--;
+	}
+	if (level >= test_level) {
+		return false;
+	}
+	const real den_floor = cascade_floor(opts().refinement_floor, level, test_level);
+	const real* rho = p.U[rho_i];
+	bool rc = false;
+#pragma GCC ivdep
+	for (integer k = 0; k < p.n; k++) {
+		rc |= rho[k] > den_floor;
+	}
+	return rc;
+}
+
+bool refine_pencil_sod(integer level, integer max_level, refine_pencil const& p) {
+	if (level >= max_level) {
+		return false;
+	}
+	const real* rho = p.U[rho_i];
+	bool rc = false;
+	for (integer dim = 0; dim != NDIM; ++dim) {
+		const integer d = H_DN[dim];
+#pragma GCC ivdep
+		for (integer k = 0; k < p.n; k++) {
+			rc |= std::abs((rho[k + d] - rho[k - d]) / 2.0) >= 0.1 * rho[k];
+		}
+	}
+	return rc;
+}
+
+bool refine_pencil_blast(integer level, integer max_level, refine_pencil const& p) {
+	if (level < 2) {
+		return true;
+	} else if (level >= max_level) {
+		return false;
+	}
+	const real* rho = p.U[rho_i];
+	const real* tau = p.U[tau_i];
+	bool rc = false;
+	for (integer dim = 0; dim != NDIM; ++dim) {
+		const integer d = H_DN[dim];
+#pragma GCC ivdep
+		for (integer k = 0; k < p.n; k++) {
+			rc |= std::abs((rho[k + d] - rho[k - d]) / 2.0) > 0.01 * rho[k];
+			rc |= std::abs((tau[k + d] - tau[k - d]) / 2.0) > 0.01;
+		}
+	}
+	return rc;
+}
+
+bool refine_pencil_test_level(integer level, integer max_level, refine_pencil const&) {
+	return level < max_level;
+}
+
+void set_refine_test(const refine_test_type& rt, const refine_pencil_test_type& prt) {
 	if( opts().unigrid) {
 		refine_test_function = refine_test_unigrid;
+		refine_pencil_test_function = refine_pencil_test_level;
 	} else {
 		refine_test_function = rt;
+		refine_pencil_test_function = prt;
 	}
 }
 
@@ -209,6 +320,10 @@ refine_test_type get_refine_test() {
 	return refine_test_function;
 }
 
+refine_pencil_test_type get_refine_pencil_test() {
+	return refine_pencil_test_function;
+}
+
 void set_problem(const init_func_type& p) {
 	problem = p;
 }
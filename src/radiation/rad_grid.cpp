@@ -14,10 +14,12 @@
 #include "octotiger/radiation/rad_grid.hpp"
 #include "octotiger/real.hpp"
 #include "octotiger/roe.hpp"
+#include "octotiger/scratch_arena.hpp"
 #include "octotiger/space_vector.hpp"
 
 #include <hpx/include/future.hpp>
 
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <string>
@@ -327,18 +329,29 @@ void rad_grid::allocate() {
 	}
 }
 
+/* Only the interior is read back by advance, the ghost zones are refilled before every flux computation */
 void rad_grid::store() {
 	for (integer f = 0; f != NRF; ++f) {
-		for (integer i = 0; i != RAD_N3; ++i) {
-			U0[f][i] = U[f][i];
+		const auto *u = U[f].data();
+		auto *u0 = U0[f].data();
+		for (integer xi = RAD_BW; xi != RAD_NX - RAD_BW; ++xi) {
+			for (integer yi = RAD_BW; yi != RAD_NX - RAD_BW; ++yi) {
+				const integer iii = rindex(xi, yi, RAD_BW);
+				std::copy_n(u + iii, INX, u0 + iii);
+			}
 		}
 	}
 }
 
 void rad_grid::restore() {
 	for (integer f = 0; f != NRF; ++f) {
-		for (integer i = 0; i != RAD_N3; ++i) {
-			U[f][i] = U0[f][i];
+		const auto *u0 = U0[f].data();
+		auto *u = U[f].data();
+		for (integer xi = RAD_BW; xi != RAD_NX - RAD_BW; ++xi) {
+			for (integer yi = RAD_BW; yi != RAD_NX - RAD_BW; ++yi) {
+				const integer iii = rindex(xi, yi, RAD_BW);
+				std::copy_n(u0 + iii, INX, u + iii);
+			}
 		}
 	}
 }
@@ -924,7 +937,11 @@ void rad_grid::complete_rad_amr_boundary() {
 	PROFILE();
 
 	using oct_array = std::array<std::array<std::array<double, 2>, 2>, 2>;
-	static thread_local std::vector<std::vector<oct_array>> Uf(NRF, std::vector<oct_array>(HS_N3));
+	octotiger::scratch_scope scratch;
+	std::array<oct_array*, NRF> Uf;
+	for (int f = 0; f < NRF; f++) {
+		Uf[f] = scratch.allocate<oct_array>(HS_N3);
+	}
 
 	std::array<double, NDIM> xmin;
 	for (int dim = 0; dim < NDIM; dim++) {
@@ -0,0 +1,103 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "octotiger/scratch_arena.hpp"
+
+#include <hpx/include/lcos.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace octotiger {
+
+static std::vector<scratch_arena*> arenas_;
+static hpx::lcos::local::spinlock mtx_;
+
+static char* align_up(char *ptr) {
+	const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+	return ptr + ((scratch_arena::alignment - addr % scratch_arena::alignment) % scratch_arena::alignment);
+}
+
+static std::size_t round_up(std::size_t bytes) {
+	return (bytes + scratch_arena::alignment - 1) / scratch_arena::alignment * scratch_arena::alignment;
+}
+
+scratch_arena::scratch_arena() :
+		capacity_(0), top_(0), overflow_bytes_(0), high_water_(0), overflow_count_(0) {
+	std::lock_guard<hpx::lcos::local::spinlock> lock(mtx_);
+	arenas_.push_back(this);
+}
+
+scratch_arena::~scratch_arena() {
+	std::lock_guard<hpx::lcos::local::spinlock> lock(mtx_);
+	arenas_.erase(std::find(arenas_.begin(), arenas_.end(), this));
+}
+
+scratch_arena& scratch_arena::local() {
+	static thread_local scratch_arena arena;
+	return arena;
+}
+
+std::size_t scratch_arena::high_water_mark() {
+	std::lock_guard<hpx::lcos::local::spinlock> lock(mtx_);
+	std::size_t hwm = 0;
+	for (const auto *a : arenas_) {
+		hwm = std::max(hwm, a->high_water_.load(std::memory_order_relaxed));
+	}
+	return hwm;
+}
+
+std::size_t scratch_arena::overflow_count() {
+	std::lock_guard<hpx::lcos::local::spinlock> lock(mtx_);
+	std::size_t cnt = 0;
+	for (const auto *a : arenas_) {
+		cnt += a->overflow_count_.load(std::memory_order_relaxed);
+	}
+	return cnt;
+}
+
+void scratch_arena::reserve(std::size_t bytes) {
+	bytes = round_up(bytes);
+	if (top_ != 0 || !overflow_.empty() || bytes <= capacity_) {
+		return;
+	}
+	block_.reset(new char[bytes + alignment]);
+	/* first touch from the owning worker */
+	std::memset(block_.get(), 0, bytes + alignment);
+	capacity_ = bytes;
+}
+
+void* scratch_arena::allocate(std::size_t bytes) {
+	bytes = round_up(bytes);
+	void *ptr;
+	if (top_ + bytes <= capacity_) {
+		ptr = align_up(block_.get()) + top_;
+		top_ += bytes;
+	} else {
+		std::unique_ptr<char[]> mem(new char[bytes + alignment]);
+		ptr = align_up(mem.get());
+		overflow_.emplace_back(std::move(mem), bytes);
+		overflow_bytes_ += bytes;
+		overflow_count_.fetch_add(1, std::memory_order_relaxed);
+	}
+	const auto used = top_ + overflow_bytes_;
+	if (used > high_water_.load(std::memory_order_relaxed)) {
+		high_water_.store(used, std::memory_order_relaxed);
+	}
+	return ptr;
+}
+
+void scratch_arena::release(const mark_type &m) {
+	while (overflow_.size() > m.overflow) {
+		overflow_bytes_ -= overflow_.back().second;
+		overflow_.pop_back();
+	}
+	top_ = m.top;
+}
+
+}
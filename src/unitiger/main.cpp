@@ -6,8 +6,16 @@
 #include <fenv.h>
 #include <time.h>
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <string>
+
 //#include <hpx/hpx_init.hpp>
 
+#include "octotiger/scratch_arena.hpp"
 #include "octotiger/unitiger/unitiger.hpp"
 #include "octotiger/unitiger/hydro.hpp"
 #include "octotiger/unitiger/physics.hpp"
@@ -21,6 +29,9 @@
 #include "octotiger/unitiger/hydro_impl/advance.hpp"
 #include "octotiger/unitiger/hydro_impl/output.hpp"
 
+/* unitiger runs on one thread, its arena is reserved once in main like octotiger's per worker arenas */
+static constexpr std::size_t scratch_size = std::size_t(4) << 20;
+
 static constexpr double tmax = 1.0;
 static constexpr safe_real dt_out = tmax / 100;
 
@@ -160,11 +171,160 @@ void run_test(typename PHYS::test_type problem, bool with_correction, bool writi
 		printf("Final %s tests are OK!!\n", type_test_string.c_str());
 }
 
+/* Per stage timings of the hydro kernels.  Bytes per cell is the compulsory traffic of the arrays a stage
+ * reads and writes (U, Q, F), so bytes/cell times cells/s is the achieved bandwidth of a streaming
+ * implementation, to be held against the machine's memory bandwidth.
+ */
+struct bench_stage {
+	std::string name;
+	double seconds;
+	double cells_per_second;
+	double bytes_per_cell;
+	double bandwidth;
+};
+
+static constexpr int bench_stage_count = 5;
+
+template<int NDIM, int INX, class PHYS>
+std::vector<bench_stage> run_bench(typename PHYS::test_type problem, bool with_correction, int iterations) {
+	using clock = std::chrono::high_resolution_clock;
+	hydro_computer<NDIM, INX, PHYS> computer;
+	if (with_correction) {
+		computer.use_angmom_correction(PHYS::get_angmom_index());
+	}
+	const auto nf = PHYS::field_count();
+	computer.use_disc_detect(PHYS::rho_i);
+	for (int s = 0; s < 5; s++) {
+		computer.use_disc_detect(PHYS::spc_i + s);
+	}
+	std::vector<std::vector<std::vector<safe_real>>> F(NDIM, std::vector<std::vector<safe_real>>(nf, std::vector<safe_real>(H_N3)));
+	std::vector<std::vector<safe_real>> U(nf, std::vector<safe_real>(H_N3));
+	hydro::x_type X(NDIM);
+	for (int dim = 0; dim < NDIM; dim++) {
+		X[dim].resize(H_N3);
+	}
+	PHYS phys;
+	computer.set_bc(phys.template initialize<INX>(problem, U, X));
+	computer.boundaries(U, X);
+	const auto U0 = U;
+	const safe_real dx = X[0][cell_geometry<NDIM, INX>::H_DNX] - X[0][0];
+	const safe_real omega = 0.0;
+	hydro::recon_type<NDIM> q = computer.reconstruct(U, X, omega);
+	const safe_real dt = (0.4 / NDIM) * dx / computer.flux(U, q, F, X, omega);
+
+	std::array<double, bench_stage_count> t = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	const auto elapsed = [](clock::time_point a, clock::time_point b) {
+		return std::chrono::duration_cast<std::chrono::duration<double>>(b - a).count();
+	};
+	for (int i = 0; i < iterations; i++) {
+		U = U0;
+		const auto t0 = clock::now();
+		const auto &qi = computer.reconstruct(U, X, omega);
+		const auto t1 = clock::now();
+		computer.flux(U, qi, F, X, omega);
+		const auto t2 = clock::now();
+		computer.advance(U0, U, F, X, dx, dt, 1.0, omega);
+		const auto t3 = clock::now();
+		computer.boundaries(U, X);
+		const auto t4 = clock::now();
+		computer.post_process(U, X, dx);
+		const auto t5 = clock::now();
+		t[0] += elapsed(t0, t1);
+		t[1] += elapsed(t1, t2);
+		t[2] += elapsed(t2, t3);
+		t[3] += elapsed(t3, t4);
+		t[4] += elapsed(t4, t5);
+	}
+
+	const double cells = std::pow(INX, NDIM);
+	const double ghosts = (H_N3 - cells) / cells;
+	const double w = sizeof(safe_real) * nf;
+	const int ndir = cell_geometry<NDIM, INX>::NDIR;
+	const std::array<const char*, bench_stage_count> names = { "reconstruct", "flux", "advance", "boundaries", "post_process" };
+	const std::array<double, bench_stage_count> bytes = { w * (1 + ndir), w * (ndir + NDIM), w * (3 + NDIM), w * 2 * ghosts, w * 2 };
+	std::vector<bench_stage> stages;
+	for (int s = 0; s < bench_stage_count; s++) {
+		bench_stage st;
+		st.name = std::to_string(NDIM) + "D/INX=" + std::to_string(INX) + "/" + PHYS::get_test_type_string(problem) + "/" + names[s];
+		st.seconds = t[s];
+		st.cells_per_second = cells * iterations / t[s];
+		st.bytes_per_cell = bytes[s];
+		st.bandwidth = st.cells_per_second * st.bytes_per_cell;
+		stages.push_back(st);
+	}
+	return stages;
+}
+
+/* One stage per line so a previous result can be read back with sscanf */
+static void write_bench(FILE *fp, const std::vector<bench_stage> &stages, int iterations) {
+	fprintf(fp, "{\n  \"iterations\": %i,\n  \"stages\": [\n", iterations);
+	for (std::size_t i = 0; i < stages.size(); i++) {
+		const auto &st = stages[i];
+		fprintf(fp, "    {\"name\": \"%s\", \"seconds\": %e, \"cells_per_second\": %e, \"bytes_per_cell\": %e, \"bandwidth\": %e}%s\n",
+				st.name.c_str(), st.seconds, st.cells_per_second, st.bytes_per_cell, st.bandwidth, i + 1 == stages.size() ? "" : ",");
+	}
+	fprintf(fp, "  ]\n}\n");
+}
+
+static std::map<std::string, double> read_bench(const char *filename) {
+	std::map<std::string, double> rates;
+	FILE *fp = fopen(filename, "rt");
+	if (fp == NULL) {
+		printf("Unable to open baseline %s\n", filename);
+		return rates;
+	}
+	char line[1024];
+	char name[512];
+	double seconds, rate;
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (sscanf(line, " {\"name\": \"%511[^\"]\", \"seconds\": %le, \"cells_per_second\": %le", name, &seconds, &rate) == 3) {
+			rates[name] = rate;
+		}
+	}
+	fclose(fp);
+	return rates;
+}
+
+static int benchmark(int iterations, const char *baseline) {
+	std::vector<bench_stage> stages;
+	const auto append = [&stages](std::vector<bench_stage> &&s) {
+		stages.insert(stages.end(), s.begin(), s.end());
+	};
+	append(run_bench<2, 64, physics<2>>(physics<2>::KEPLER, true, iterations));
+	append(run_bench<2, 50, physics<2>>(physics<2>::BLAST, true, iterations));
+	append(run_bench<3, 8, physics<3>>(physics<3>::SOD, false, iterations));
+	FILE *fp = fopen("unitiger_bench.json", "wt");
+	if (fp == NULL) {
+		printf("Unable to open unitiger_bench.json\n");
+	} else {
+		write_bench(fp, stages, iterations);
+		fclose(fp);
+	}
+	for (const auto &st : stages) {
+		printf("%-40s %12.4e cells/s %8.1f bytes/cell %8.3f GB/s\n", st.name.c_str(), st.cells_per_second, st.bytes_per_cell, st.bandwidth / 1.0e9);
+	}
+	if (baseline != nullptr) {
+		const auto rates = read_bench(baseline);
+		printf("\nSpeedup against %s\n", baseline);
+		for (const auto &st : stages) {
+			const auto i = rates.find(st.name);
+			if (i != rates.end()) {
+				printf("%-40s %8.3f\n", st.name.c_str(), st.cells_per_second / i->second);
+			} else {
+				printf("%-40s      n/a\n", st.name.c_str());
+			}
+		}
+	}
+	return 0;
+}
+
 int main(int argc, char *argv[]) {
 	feenableexcept(FE_DIVBYZERO);
 	feenableexcept(FE_INVALID);
 	feenableexcept(FE_OVERFLOW);
 
+	octotiger::scratch_arena::local().reserve(scratch_size);
+
 	bool createTests = false;
 
 	if (argc > 1) {
@@ -172,6 +332,21 @@ int main(int argc, char *argv[]) {
 		if (input == "-C") {
 			printf("Creating Tests.\n");
 			createTests = true;
+		} else if (input == "-B") {
+			/* unitiger -B [iterations] [baseline.json] */
+			long iterations = 100;
+			if (argc > 2) {
+				char *end;
+				iterations = std::strtol(argv[2], &end, 10);
+				if (end == argv[2] || *end != '\0') {
+					iterations = 0;
+				}
+			}
+			if (iterations < 1 || iterations > std::numeric_limits<int>::max()) {
+				printf("Usage: unitiger -B [iterations >= 1] [baseline.json]\n");
+				return 1;
+			}
+			return benchmark(int(iterations), argc > 3 ? argv[3] : nullptr);
 		}
 	}
 
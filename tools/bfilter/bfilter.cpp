@@ -7,11 +7,14 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <vector>
 #include <math.h>
 #include <iostream>
 #include <complex>
+#include <thread>
 #include <boost/program_options.hpp>
 
 auto band_filter(double t, double Ps, double Pc) {
@@ -35,15 +38,20 @@ void output_spectrogram(double Ps, double Pc) {
 	double dp = (pmax - pmin) / 1000.0;
 	const auto dt = Ps / 100000.0;
 	FILE *fp = fopen("filter.dat", "wt");
+	/* the filter does not depend on the period, tabulate it once */
+	std::vector<double> ts, bfs;
+	double w = 0.0;
+	for (double t = dt / 2.0; t < Ps / 2.0; t += dt) {
+		const auto bf = band_filter(t, Ps, Pc);
+		ts.push_back(t);
+		bfs.push_back(bf);
+		w += 2.0 * bf * dt;
+	}
 	for (auto p = pmin; p <= pmax; p += dp) {
-		double w = 0.0;
 		const auto omega = 2.0 * M_PI / p;
 		double sum = 0.0;
-		constexpr std::complex<double> I(0, 1);
-		for (double t = dt / 2.0; t < Ps / 2.0; t += dt) {
-			const auto bf = band_filter(t, Ps, Pc);
-			w += 2.0 * bf * dt;
-			sum += 2.0 * bf * cos(omega * t) * dt;
+		for (std::size_t i = 0; i < ts.size(); i++) {
+			sum += 2.0 * bfs[i] * cos(omega * ts[i]) * dt;
 		}
 		sum /= w;
 		fprintf(fp, "%.12e %.12e\n", p, sum);
@@ -72,53 +80,113 @@ auto derivative(const std::vector<std::vector<double>> &f, double omega) {
 
 }
 
-auto filter(const std::vector<std::vector<double>> &f, double omega, double Pc, double Ps) {
-	std::vector<std::vector<double>> g;
-	std::vector<double> u(f[0].size());
-
+/* Filters every column of f with the band filter centred on each sample.
+ *
+ * Only samples within Pc/2 of the output time contribute, so the contributing range is found by a
+ * binary search and the sum runs over the window only.  The Simpson weights of a sample do not depend
+ * on the output time and are computed once.  The filter value of each sample in the window is evaluated
+ * once per output time instead of once for each of its three Simpson terms, and for uniformly sampled
+ * data the filter is tabulated once by sample offset.  Output times are distributed over nthreads threads.
+ */
+auto filter(const std::vector<std::vector<double>> &f, double omega, double Pc, double Ps, int nthreads) {
+	const int N = f.size();
+	const int ncol = f[0].size();
 	const auto tmin = f[0][0];
-	const auto tmax = f[f.size() - 1][0];
+	const auto tmax = f[N - 1][0];
 	const auto P = 2.0 * M_PI / omega;
-	double rt = tmin / P;
 	Pc *= P;
 	Ps *= P;
-	for (int n = 1; n < f.size() - 1; n++) {
-		double t0 = f[n][0];
-		double dt;
-		double weight = 0.0;
-
-		if (Pc / 2.0 + tmin < t0 && t0 < tmax - Pc / 2.0) {
-			std::fill(u.begin(), u.end(), 0.0);
-			for (int m = 1; m < f.size() - 1; m++) {
-				double t = f[m][0];
-				if (t0 - Pc / 2.0 < t && t < t0 + Pc / 2.0) {
-					dt = (f[m + 1][0] - f[m - 1][0]) / 2.0;
-					const auto h1 = f[m][0] - f[m - 1][0];
-					const auto h2 = f[m + 1][0] - f[m][0];
-					const auto w1 = (h1 + h2) * (2 * h1 - h2) / h1 / 6.0;
-					const auto w2 = std::pow(h1 + h2, 3) / h2 / h1 / 6.0;
-					const auto w3 = (h1 + h2) * (2 * h2 - h1) / h2 / 6.0;
-					double y1 = band_filter(f[m - 1][0] - t0, Ps, Pc);
-					double y2 = band_filter(f[m][0] - t0, Ps, Pc);
-					double y3 = band_filter(f[m + 1][0] - t0, Ps, Pc);
-					for (int i = 0; i < u.size(); i++) {
-						u[i] += w1 * f[m - 1][i] * y1 * dt;
-						u[i] += w2 * f[m][i] * y2 * dt;
-						u[i] += w3 * f[m + 1][i] * y3 * dt;
+
+	std::vector<double> t(N);
+	for (int m = 0; m < N; m++) {
+		t[m] = f[m][0];
+	}
+
+	/* weights of samples m - 1, m and m + 1 in the integral over sample m */
+	std::vector<double> w1(N, 0.0), w2(N, 0.0), w3(N, 0.0);
+	for (int m = 1; m < N - 1; m++) {
+		const auto dt = (t[m + 1] - t[m - 1]) / 2.0;
+		const auto h1 = t[m] - t[m - 1];
+		const auto h2 = t[m + 1] - t[m];
+		w1[m] = (h1 + h2) * (2 * h1 - h2) / h1 / 6.0 * dt;
+		w2[m] = std::pow(h1 + h2, 3) / h2 / h1 / 6.0 * dt;
+		w3[m] = (h1 + h2) * (2 * h2 - h1) / h2 / 6.0 * dt;
+	}
+
+	std::vector<int> rows;
+	std::vector<double> rts;
+	double rt = tmin / P;
+	for (int n = 1; n < N - 1; n++) {
+		if (Pc / 2.0 + tmin < t[n] && t[n] < tmax - Pc / 2.0) {
+			rows.push_back(n);
+			rts.push_back(rt);
+		}
+		rt += (t[n + 1] - t[n - 1]) / 2.0 / P;
+	}
+
+	const auto h = (tmax - tmin) / (N - 1);
+	bool uniform = true;
+	for (int m = 1; m < N && uniform; m++) {
+		uniform = std::abs(t[m] - t[m - 1] - h) <= 1.0e-6 * h;
+	}
+	std::vector<double> kernel;
+	int K = 0;
+	if (uniform) {
+		K = int(std::ceil(Pc / 2.0 / h)) + 2;
+		kernel.resize(2 * K + 1);
+		for (int k = -K; k <= K; k++) {
+			kernel[k + K] = band_filter(k * h, Ps, Pc);
+		}
+	}
+
+	std::vector<std::vector<double>> g(rows.size(), std::vector<double>(ncol));
+	std::atomic<std::size_t> next(0);
+	constexpr std::size_t chunk = 64;
+	const auto work = [&]() {
+		std::vector<double> y, coef;
+		for (std::size_t r0 = next.fetch_add(chunk); r0 < rows.size(); r0 = next.fetch_add(chunk)) {
+			for (std::size_t r = r0; r < std::min(r0 + chunk, rows.size()); r++) {
+				const int n = rows[r];
+				const double t0 = t[n];
+				const int lo = std::max(1, int(std::upper_bound(t.begin(), t.end(), t0 - Pc / 2.0) - t.begin()));
+				const int hi = std::min(N - 1, int(std::lower_bound(t.begin(), t.end(), t0 + Pc / 2.0) - t.begin()));
+				/* samples lo - 1 ... hi take part */
+				const int width = hi - lo + 2;
+				y.resize(width);
+				coef.assign(width, 0.0);
+				for (int j = lo - 1; j <= hi; j++) {
+					y[j - lo + 1] = uniform ? kernel[j - n + K] : band_filter(t[j] - t0, Ps, Pc);
+				}
+				for (int m = lo; m < hi; m++) {
+					const int j = m - lo + 1;
+					coef[j - 1] += w1[m] * y[j - 1];
+					coef[j] += w2[m] * y[j];
+					coef[j + 1] += w3[m] * y[j + 1];
+				}
+				auto &u = g[r];
+				double weight = 0.0;
+				for (int j = 0; j < width; j++) {
+					const auto c = coef[j];
+					const auto &fj = f[lo - 1 + j];
+					for (int i = 0; i < ncol; i++) {
+						u[i] += c * fj[i];
 					}
-					weight += w1 * y1 * dt;
-					weight += w2 * y2 * dt;
-					weight += w3 * y3 * dt;
+					weight += c;
 				}
+				for (int i = 0; i < ncol; i++) {
+					u[i] /= weight;
+				}
+				u[0] = rts[r];
 			}
-			for (int i = 0; i < u.size(); i++) {
-				u[i] /= weight;
-			}
-			u[0] = rt;
-			g.push_back(u);
 		}
-		dt = (f[n + 1][0] - f[n - 1][0]) / 2.0;
-		rt += dt / P;
+	};
+	std::vector<std::thread> workers;
+	for (int i = 1; i < nthreads; i++) {
+		workers.emplace_back(work);
+	}
+	work();
+	for (auto &w : workers) {
+		w.join();
 	}
 	return g;
 }
@@ -126,6 +194,7 @@ auto filter(const std::vector<std::vector<double>> &f, double omega, double Pc,
 struct options {
 	double pmin;
 	double pmax;
+	int threads;
 	bool help;
 	bool normalize;
 	std::string input;
@@ -140,6 +209,7 @@ struct options {
 		("input", po::value<std::string>(&input)->default_value("binary.dat"), "input filename")           //
 		("pmin", po::value<double>(&pmin)->default_value(1.25), "minimum period to allow through filter")           //
 		("pmax", po::value<double>(&pmax)->default_value(5), "period where filter allows 100%")           //
+		("threads", po::value<int>(&threads)->default_value(std::thread::hardware_concurrency()), "number of threads used by the filter")           //
 		("normalize", po::value<bool>(&normalize)->default_value(true), "normalize averages to t=0 value")           //
 		("help", po::value<bool>(&help)->default_value(false), "show the help page")           //
 				;
@@ -214,7 +284,7 @@ int main(int argc, char *argv[]) {
 
 		printf("Window is +/- %.12e orbits\n", Pc / 2.0);
 
-		auto v2 = filter(v1, v1[0][2], Pc, Ps);
+		auto v2 = filter(v1, v1[0][2], Pc, Ps, opts.threads);
 		if (v2.size() == 0) {
 			printf("Not enough data to produce output\n");
 		} else {
@@ -226,7 +296,7 @@ int main(int argc, char *argv[]) {
 				}
 			}
 			const auto v4 = derivative(v1, v1[0][2]);
-			const auto v3 = filter(v4, v1[0][2], Pc, Ps);
+			const auto v3 = filter(v4, v1[0][2], Pc, Ps, opts.threads);
 			FILE *fp1 = fopen("avg.dat", "wt");
 			FILE *fp2 = fopen("drv.dat", "wt");
 			for (const auto &i : v2) {
@@ -3,162 +3,510 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+/* Compares two Silo outputs block by block and reports L1, L2 and Linf error norms per variable.
+ *
+ * Both arguments may be an Octo-tiger master file (blocks are found through the "quadmesh" multimesh,
+ * data files are opened relative to the master) or a single data file (blocks are the top level
+ * directories holding a quadmesh).  Blocks are matched by their directory name, i.e. the node location.
+ *
+ * Silo and HDF5 are not thread safe, so every library call goes through one lock.  Worker threads take
+ * one block at a time, copy its variables out under the lock and compute the norms, and the optional
+ * diff output, outside of it.  Only one block per worker is ever in memory.
+ *
+ * The exit status is 0 when every cell of every variable agrees within the tolerances, 1 otherwise:
+ * a cell differs when |a - b| exceeds both atol and rtol * max(|a|, |b|).  It is 2 when a file cannot be
+ * read; a worker that fails records the error and stops, and it is reported once all workers are joined.
+ */
+
 #include <algorithm>
+#include <atomic>
 #include <cmath>
-#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
 #include <iostream>
-#include <set>
-#include <cassert>
-#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <silo.h>
 
 #define SILO_DRIVER DB_HDF5
 
-std::string strip_nonnumeric(std::string &&s) {
-	s.erase(std::remove_if(s.begin(), s.end(), [](char c) {
-		return c < '0' || c > '9';
-	}), s.end());
-	return std::move(s);
-}
+namespace {
 
-struct silo_file {
-	DBfile *handle;
-	std::set<std::string> var_names;
-	std::set<std::string> mesh_names;
+struct compare_options {
+	std::string file1;
+	std::string file2;
+	std::string diff_file;
+	double rtol = 0.0;
+	double atol = 0.0;
+	int threads = 0;
+	bool history = false;
+};
 
-	silo_file(std::string const name) {
-		handle = DBOpenReal(name.c_str(), SILO_DRIVER, DB_READ);
+struct error_norms {
+	double l1 = 0.0;
+	double l2 = 0.0;
+	double linf = 0.0;
+	double volume = 0.0;
+	std::size_t mismatches = 0;
+	std::size_t missing = 0;
 
-		//      std::cout << "Variables in " << name << " are:\n";
-		auto toc = DBGetToc(handle);
-		for (int i = 0; i < toc->nmultivar; ++i) {
-			auto name = std::string(toc->multivar_names[i]);
-			var_names.insert(name);
-			// std::cout << "   " << name << "\n";
+	error_norms& operator+=(const error_norms &other) {
+		l1 += other.l1;
+		l2 += other.l2;
+		linf = std::max(linf, other.linf);
+		volume += other.volume;
+		mismatches += other.mismatches;
+		missing += other.missing;
+		return *this;
+	}
+};
+
+/* Where a block lives: the file it is stored in and its directory inside that file */
+struct block_location {
+	std::string file;
+	std::string dir;
+};
+
+std::mutex silo_mtx;
+
+std::string directory_of(const std::string &path) {
+	const auto pos = path.find_last_of('/');
+	return pos == std::string::npos ? std::string() : path.substr(0, pos + 1);
+}
+
+/* Open files, shared by all workers.  Must only be used while holding silo_mtx. */
+class silo_files {
+public:
+	~silo_files() {
+		for (auto &f : files_) {
+			DBClose(f.second);
 		}
+	}
 
-//         std::cout << "Meshes in " << name << " are:\n";
-		auto mesh = DBGetMultimesh(handle, "quadmesh");
-		for (int i = 0; i < mesh->nblocks; ++i) {
-			auto name = strip_nonnumeric(std::string(mesh->meshnames[i]));
-			mesh_names.insert(name);
-			//       std::cout << "   " << name << "\n";
+	DBfile* get(const std::string &name) {
+		auto it = files_.find(name);
+		if (it == files_.end()) {
+			auto *db = DBOpenReal(name.c_str(), SILO_DRIVER, DB_READ);
+			if (db == nullptr) {
+				throw std::runtime_error("unable to open " + name);
+			}
+			it = files_.emplace(name, db).first;
 		}
+		return it->second;
+	}
+
+private:
+	std::map<std::string, DBfile*> files_;
+};
 
+/* Block directory name -> location, either from the multimesh of a master file or from the directories of a data file */
+std::map<std::string, block_location> find_blocks(silo_files &files, const std::string &name) {
+	std::map<std::string, block_location> blocks;
+	auto *db = files.get(name);
+	if (DBInqVarExists(db, "quadmesh")) {
+		auto *mesh = DBGetMultimesh(db, "quadmesh");
+		const auto base = directory_of(name);
+		for (int i = 0; i < mesh->nblocks; ++i) {
+			const std::string mesh_name = mesh->meshnames[i];
+			const auto colon = mesh_name.find(':');
+			block_location loc;
+			std::string path;
+			if (colon == std::string::npos) {
+				loc.file = name;
+				path = mesh_name;
+			} else {
+				loc.file = base + mesh_name.substr(0, colon);
+				path = mesh_name.substr(colon + 1);
+			}
+			loc.dir = path.substr(0, path.find_last_of('/'));
+			blocks[loc.dir.substr(loc.dir.find_last_of('/') + 1)] = loc;
+		}
 		DBFreeMultimesh(mesh);
+	} else {
+		const auto *toc = DBGetToc(db);
+		std::vector<std::string> dirs(toc->dir_names, toc->dir_names + toc->ndir);
+		for (const auto &dir : dirs) {
+			if (DBInqVarExists(db, ("/" + dir + "/quadmesh").c_str())) {
+				blocks[dir] = block_location { name, "/" + dir };
+			}
+		}
+	}
+	return blocks;
+}
+
+/* Variable names, from the multivars of a master file or from the quadvars of the first block */
+std::vector<std::string> find_variables(silo_files &files, const std::string &name, const std::map<std::string, block_location> &blocks) {
+	std::vector<std::string> vars;
+	auto *db = files.get(name);
+	const auto *toc = DBGetToc(db);
+	if (toc->nmultivar > 0) {
+		vars.assign(toc->multivar_names, toc->multivar_names + toc->nmultivar);
+	} else if (!blocks.empty()) {
+		const auto &first = blocks.begin()->second;
+		auto *bdb = files.get(first.file);
+		DBSetDir(bdb, first.dir.c_str());
+		toc = DBGetToc(bdb);
+		vars.assign(toc->qvar_names, toc->qvar_names + toc->nqvar);
+		DBSetDir(bdb, "/");
+	}
+	std::sort(vars.begin(), vars.end());
+	return vars;
+}
+
+/* Copies the values of a quadvar out of the library, converting single precision output to double */
+bool read_values(DBfile *db, const std::string &path, std::vector<double> &values) {
+	auto *var = DBGetQuadvar(db, path.c_str());
+	if (var == nullptr) {
+		return false;
+	}
+	values.resize(var->nels);
+	if (var->datatype == DB_FLOAT) {
+		const auto *src = static_cast<const float*>(var->vals[0]);
+		std::copy(src, src + var->nels, values.begin());
+	} else {
+		const auto *src = static_cast<const double*>(var->vals[0]);
+		std::copy(src, src + var->nels, values.begin());
+	}
+	DBFreeQuadvar(var);
+	return true;
+}
+
+double cell_volume(const DBquadmesh *mesh) {
+	double dx;
+	if (mesh->datatype == DB_FLOAT) {
+		const auto *X = static_cast<const float*>(mesh->coords[0]);
+		dx = X[1] - X[0];
+	} else {
+		const auto *X = static_cast<const double*>(mesh->coords[0]);
+		dx = X[1] - X[0];
+	}
+	return dx * dx * dx;
+}
+
+/* Norm sums of one block.  The independent lane accumulators let the compiler keep the loop in vector registers. */
+error_norms block_norms(const double *a, const double *b, std::size_t n, double dv, double rtol, double atol) {
+	constexpr std::size_t lanes = 8;
+	double s1[lanes] = { };
+	double s2[lanes] = { };
+	double mx[lanes] = { };
+	std::size_t bad[lanes] = { };
+	const auto cell = [&](std::size_t i, std::size_t l) {
+		const double d = std::abs(a[i] - b[i]);
+		const double tol = std::max(atol, rtol * std::max(std::abs(a[i]), std::abs(b[i])));
+		s1[l] += d;
+		s2[l] += d * d;
+		mx[l] = std::max(mx[l], d);
+		/* written so that a NaN counts as a mismatch */
+		bad[l] += !(d <= tol);
+	};
+	std::size_t i = 0;
+	for (; i + lanes <= n; i += lanes) {
+		for (std::size_t l = 0; l < lanes; ++l) {
+			cell(i + l, l);
+		}
+	}
+	for (; i < n; ++i) {
+		cell(i, 0);
+	}
+	error_norms norms;
+	for (std::size_t l = 0; l < lanes; ++l) {
+		norms.l1 += s1[l];
+		norms.l2 += s2[l];
+		norms.linf = std::max(norms.linf, mx[l]);
+		norms.mismatches += bad[l];
+	}
+	norms.l1 *= dv;
+	norms.l2 *= dv;
+	norms.volume = n * dv;
+	return norms;
+}
+
+class comparison {
+public:
+	comparison(const compare_options &opts) :
+			opts_(opts) {
+		blocks1_ = find_blocks(files_, opts.file1);
+		blocks2_ = find_blocks(files_, opts.file2);
+		vars_ = find_variables(files_, opts.file1, blocks1_);
+		const auto vars2 = find_variables(files_, opts.file2, blocks2_);
+		for (const auto &v : vars_) {
+			if (!std::binary_search(vars2.begin(), vars2.end(), v)) {
+				std::cout << "variable " << v << " missing in " << opts.file2 << "\n";
+				missing_ = true;
+			}
+		}
+		for (const auto &b : blocks1_) {
+			if (blocks2_.count(b.first) == 0) {
+				std::cout << "block " << b.first << " missing in " << opts.file2 << "\n";
+				missing_ = true;
+			} else {
+				keys_.push_back(b.first);
+			}
+		}
+		if (blocks1_.size() != blocks2_.size()) {
+			std::cout << opts.file1 << " has " << blocks1_.size() << " blocks, " << opts.file2 << " has " << blocks2_.size() << "\n";
+			missing_ = true;
+		}
+		if (!opts.diff_file.empty()) {
+			diff_ = DBCreateReal(opts.diff_file.c_str(), DB_CLOBBER, DB_LOCAL, "silo_compare", SILO_DRIVER);
+		}
+	}
+
+	~comparison() {
+		if (diff_ != nullptr) {
+			DBClose(diff_);
+		}
+	}
+
+	/* Returns true when the files agree within the tolerances */
+	bool run() {
+		const int nthreads = std::max(1, std::min<int>(opts_.threads, keys_.size()));
+		std::vector<std::vector<error_norms>> partial(nthreads, std::vector<error_norms>(vars_.size()));
+		std::vector<std::thread> workers;
+		for (int t = 0; t < nthreads; ++t) {
+			workers.emplace_back([this, &partial, t]() {
+				work(partial[t]);
+			});
+		}
+		for (auto &w : workers) {
+			w.join();
+		}
+		if (failed_) {
+			throw std::runtime_error(error_);
+		}
+		std::vector<error_norms> norms(vars_.size());
+		for (const auto &p : partial) {
+			for (std::size_t v = 0; v < vars_.size(); ++v) {
+				norms[v] += p[v];
+			}
+		}
+		if (diff_ != nullptr) {
+			write_multiobjects();
+		}
+		return report(norms) && !missing_;
+	}
+
+private:
+	void work(std::vector<error_norms> &norms) {
+		try {
+			work_blocks(norms);
+		} catch (const std::exception &e) {
+			std::lock_guard<std::mutex> lock(silo_mtx);
+			if (!failed_) {
+				error_ = e.what();
+				failed_ = true;
+			}
+		}
 	}
 
-	void compare(std::string const name) {
-		auto other = DBOpenReal(name.c_str(), SILO_DRIVER, DB_READ);
-		std::string copy = std::string("cp ") + name + std::string(" diff.silo\n");
-		std::cout << copy;
-		if (std::system(copy.c_str()) != 0) {
-			assert(false);
-		}
-		auto diff = DBOpenReal("diff.silo", SILO_DRIVER, DB_APPEND);
-		double this_time;
-		FILE *fp1, *fp2, *fpinf;
-		fp1 = fopen("L1.dat", "at");
-		fp2 = fopen("L2.dat", "at");
-		fpinf = fopen("Linf.dat", "at");
-		bool first_var = true;
-		DBReadVar(handle, "dtime", &this_time);
-		for (auto const &vn : var_names) {
-			double vtot = 0.0;
-			double l1 = 0.0;
-			double l2 = 0.0;
-			double linf = 0.0;
-			for (auto const &mn : mesh_names) {
-				std::string mesh_loc = "/" + mn + "/quadmesh";
-				std::string var_loc = "/" + mn + "/" + vn;
-
-				auto quadmesh = DBGetQuadmesh(handle, mesh_loc.c_str());
-				double *X = static_cast<double*>(quadmesh->coords[0]);
-				auto const dx = X[1] - X[0];
-				auto const dv = dx * dx * dx;
-
-				auto this_var = DBGetQuadvar(handle, var_loc.c_str());
-				auto other_var = DBGetQuadvar(other, var_loc.c_str());
-				auto const n = this_var->dims[0] * this_var->dims[1] * this_var->dims[2];
-				for (int i = 0; i < n; i++) {
-					double &this_val = static_cast<double*>(this_var->vals[0])[i];
-					double other_val = static_cast<double*>(other_var->vals[0])[i];
-					auto d = std::abs(this_val - other_val);
-					l1 += d * dv;
-					l2 += d * d * dv;
-					linf = std::max(linf, d);
-					vtot += dv;
-					this_val -= other_val;
+	void work_blocks(std::vector<error_norms> &norms) {
+		std::vector<std::vector<double>> a(vars_.size()), b(vars_.size());
+		std::vector<char> present(vars_.size());
+		std::vector<double> d;
+		std::vector<int> dims;
+		for (std::size_t k = next_++; k < keys_.size() && !failed_; k = next_++) {
+			const auto &key = keys_[k];
+			const auto &loc1 = blocks1_.at(key);
+			const auto &loc2 = blocks2_.at(key);
+			double dv;
+			{
+				std::lock_guard<std::mutex> lock(silo_mtx);
+				auto *db1 = files_.get(loc1.file);
+				auto *db2 = files_.get(loc2.file);
+				auto *mesh = DBGetQuadmesh(db1, (loc1.dir + "/quadmesh").c_str());
+				if (mesh == nullptr) {
+					throw std::runtime_error("unable to read " + loc1.dir + "/quadmesh in " + loc1.file);
+				}
+				dv = cell_volume(mesh);
+				dims.assign(mesh->dims, mesh->dims + mesh->ndims);
+				for (auto &n : dims) {
+					--n;
+				}
+				if (diff_ != nullptr) {
+					DBMkDir(diff_, key.c_str());
+					DBSetDir(diff_, key.c_str());
+					DBPutQuadmesh(diff_, "quadmesh", mesh->labels, mesh->coords, mesh->dims, mesh->ndims, mesh->datatype, mesh->coordtype, nullptr);
+					DBSetDir(diff_, "/");
+				}
+				DBFreeQuadmesh(mesh);
+				for (std::size_t v = 0; v < vars_.size(); ++v) {
+					present[v] = read_values(db1, loc1.dir + "/" + vars_[v], a[v]) && read_values(db2, loc2.dir + "/" + vars_[v], b[v])
+							&& a[v].size() == b[v].size();
 				}
-				auto optlist = DBMakeOptlist(100);
-				int one = 1;
-				DBAddOption(optlist, DBOPT_HIDE_FROM_GUI, &one);
-				std::string diff_loc = var_loc + std::string("_diff");
-				DBPutQuadvar1(diff, diff_loc.c_str(), this_var->meshname, static_cast<double*>(this_var->vals[0]), this_var->dims, this_var->ndims, nullptr, 0,
-						this_var->datatype, this_var->centering, optlist);
-
-				DBFreeOptlist(optlist);
-
-				DBFreeQuadvar(this_var);
-				DBFreeQuadvar(other_var);
-				DBFreeQuadmesh(quadmesh);
-
-			}
-			auto mv = DBGetMultivar(diff, vn.c_str());
-			auto const name = vn + std::string("_diff");
-			std::vector<char*> names;
-			for (int i = 0; i < mv->nvars; i++) {
-				auto const name = std::string(mv->varnames[i]) + std::string("_diff");
-				char *ptr = new char[name.size() + 1];
-				std::strcpy(ptr, name.c_str());
-				names.push_back(ptr);
-			}
-			DBPutMultivar(diff, name.c_str(), mv->nvars, names.data(), mv->vartypes, nullptr);
-			for (auto &n : names) {
-				delete[] n;
-			}
-			DBFreeMultivar(mv);
-			l1 = l1 / vtot;
-			l2 = std::sqrt(l2 / vtot);
-			printf("variable: %s\n", vn.c_str());
+			}
+			for (std::size_t v = 0; v < vars_.size(); ++v) {
+				if (!present[v]) {
+					++norms[v].missing;
+					continue;
+				}
+				norms[v] += block_norms(a[v].data(), b[v].data(), a[v].size(), dv, opts_.rtol, opts_.atol);
+			}
+			if (diff_ != nullptr) {
+				write_diff(key, dims, a, b, present, d);
+			}
+		}
+	}
+
+	void write_diff(const std::string &key, std::vector<int> &dims, const std::vector<std::vector<double>> &a, const std::vector<std::vector<double>> &b,
+			const std::vector<char> &present, std::vector<double> &d) {
+		for (std::size_t v = 0; v < vars_.size(); ++v) {
+			if (!present[v]) {
+				continue;
+			}
+			d.resize(a[v].size());
+			for (std::size_t i = 0; i < d.size(); ++i) {
+				d[i] = a[v][i] - b[v][i];
+			}
+			std::lock_guard<std::mutex> lock(silo_mtx);
+			DBSetDir(diff_, key.c_str());
+			DBPutQuadvar1(diff_, vars_[v].c_str(), "quadmesh", d.data(), dims.data(), dims.size(), nullptr, 0, DB_DOUBLE, DB_ZONECENT, nullptr);
+			DBSetDir(diff_, "/");
+		}
+	}
+
+	void write_multiobjects() {
+		const auto put = [this](const std::string &name, int type, bool is_mesh) {
+			std::vector<std::string> paths;
+			for (const auto &key : keys_) {
+				paths.push_back("/" + key + "/" + name);
+			}
+			std::vector<char*> ptrs;
+			for (auto &p : paths) {
+				ptrs.push_back(&p[0]);
+			}
+			std::vector<int> types(ptrs.size(), type);
+			if (is_mesh) {
+				DBPutMultimesh(diff_, name.c_str(), ptrs.size(), ptrs.data(), types.data(), nullptr);
+			} else {
+				DBPutMultivar(diff_, name.c_str(), ptrs.size(), ptrs.data(), types.data(), nullptr);
+			}
+		};
+		put("quadmesh", DB_QUADRECT, true);
+		for (const auto &v : vars_) {
+			put(v, DB_QUADVAR, false);
+		}
+	}
+
+	bool report(const std::vector<error_norms> &norms) {
+		bool pass = true;
+		FILE *fp1 = nullptr, *fp2 = nullptr, *fpinf = nullptr;
+		if (opts_.history) {
+			double this_time = 0.0;
+			auto *db = files_.get(opts_.file1);
+			if (DBInqVarExists(db, "dtime")) {
+				DBReadVar(db, "dtime", &this_time);
+			}
+			fp1 = fopen("L1.dat", "at");
+			fp2 = fopen("L2.dat", "at");
+			fpinf = fopen("Linf.dat", "at");
+			fprintf(fp1, "%e ", this_time);
+			fprintf(fp2, "%e ", this_time);
+			fprintf(fpinf, "%e ", this_time);
+		}
+		for (std::size_t v = 0; v < vars_.size(); ++v) {
+			const auto &n = norms[v];
+			const double vtot = n.volume > 0.0 ? n.volume : 1.0;
+			const double l1 = n.l1 / vtot;
+			const double l2 = std::sqrt(n.l2 / vtot);
+			printf("variable: %s\n", vars_[v].c_str());
 			printf("     L1 : %e\n", l1);
 			printf("     L2 : %e\n", l2);
-			printf("     Linf : %e\n", linf);
-			if (first_var) {
-				first_var = false;
-				fprintf(fp1, "%e ", this_time);
-				fprintf(fp2, "%e ", this_time);
-				fprintf(fpinf, "%e ", this_time);
-			}
-			fprintf(fp1, "%e ", l1);
-			fprintf(fp2, "%e ", l2);
-			fprintf(fpinf, "%e ", linf);
-		}
-		fprintf(fp1, "\n");
-		fprintf(fp2, "\n");
-		fprintf(fpinf, "\n");
-		DBClose(other);
-		DBClose(diff);
-		fclose(fp1);
-		fclose(fp2);
-		fclose(fpinf);
-	}
-
-	~silo_file() {
-		DBClose(handle);
+			printf("     Linf : %e\n", n.linf);
+			if (n.mismatches != 0 || n.missing != 0) {
+				printf("     FAILED : %lu cells out of tolerance, %lu blocks missing\n", static_cast<unsigned long>(n.mismatches),
+						static_cast<unsigned long>(n.missing));
+				pass = false;
+			}
+			if (opts_.history) {
+				fprintf(fp1, "%e ", l1);
+				fprintf(fp2, "%e ", l2);
+				fprintf(fpinf, "%e ", n.linf);
+			}
+		}
+		if (opts_.history) {
+			fprintf(fp1, "\n");
+			fprintf(fp2, "\n");
+			fprintf(fpinf, "\n");
+			fclose(fp1);
+			fclose(fp2);
+			fclose(fpinf);
+		}
+		return pass;
 	}
+
+	compare_options opts_;
+	silo_files files_;
+	std::map<std::string, block_location> blocks1_;
+	std::map<std::string, block_location> blocks2_;
+	std::vector<std::string> keys_;
+	std::vector<std::string> vars_;
+	std::atomic<std::size_t> next_ { 0 };
+	DBfile *diff_ = nullptr;
+	bool missing_ = false;
+	/* the first error of a worker, written under silo_mtx */
+	std::atomic<bool> failed_ { false };
+	std::string error_;
 };
 
+void usage() {
+	std::cout << "Usage -> silo_compare [options] <file1> <file2>\n";
+	std::cout << "   --rtol=<x>      relative tolerance per cell (default 0)\n";
+	std::cout << "   --atol=<x>      absolute tolerance per cell (default 0)\n";
+	std::cout << "   --threads=<n>   worker threads (default: hardware concurrency)\n";
+	std::cout << "   --diff=<file>   write file1 - file2 to a new Silo file\n";
+	std::cout << "   --history       append the norms to L1.dat, L2.dat and Linf.dat\n";
+}
+
+}
+
 int main(int argc, char *argv[]) {
-	if (argc != 3) {
-		std::cout << "Usage -> compare <file1> <file2>\n";
-		return -1;
-	} else {
-		silo_file file1(argv[1]);
-		file1.compare(argv[2]);
+	compare_options opts;
+	opts.threads = std::thread::hardware_concurrency();
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const auto value = [&arg]() {
+			return arg.substr(arg.find('=') + 1);
+		};
+		if (arg.compare(0, 7, "--rtol=") == 0) {
+			opts.rtol = std::stod(value());
+		} else if (arg.compare(0, 7, "--atol=") == 0) {
+			opts.atol = std::stod(value());
+		} else if (arg.compare(0, 10, "--threads=") == 0) {
+			opts.threads = std::stoi(value());
+		} else if (arg.compare(0, 7, "--diff=") == 0) {
+			opts.diff_file = value();
+		} else if (arg == "--history") {
+			opts.history = true;
+		} else if (arg.compare(0, 2, "--") == 0) {
+			usage();
+			return 2;
+		} else {
+			files.push_back(arg);
+		}
+	}
+	if (files.size() != 2) {
+		usage();
+		return 2;
+	}
+	opts.file1 = files[0];
+	opts.file2 = files[1];
+	DBShowErrors(DB_NONE, nullptr);
+	try {
+		comparison cmp(opts);
+		if (cmp.run()) {
+			printf("PASSED\n");
+			return 0;
+		}
+	} catch (const std::exception &e) {
+		std::cerr << "silo_compare: " << e.what() << "\n";
+		return 2;
 	}
-	return 0;
+	printf("FAILED\n");
+	return 1;
 }
@@ -0,0 +1,79 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+/* Runs several analyses over a series of Silo outputs, reading every file once and several files at a time */
+
+#include "silo_analyses.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void usage() {
+	printf("Usage: silo_analyze [options] <file> [<file> ...]\n");
+	printf("   --threads=<n>   files processed at a time (default: hardware concurrency)\n");
+	printf("   --planes        extract the z = 0 plane to plane.<file>\n");
+	printf("   --dredge        append the species 1 dredge up masses to dredge.dat\n");
+	printf("   --omega         write the rotation profile to omega.<file>.dat\n");
+	printf("   --species       append the total mass of every species to species.dat\n");
+	printf("   --counts        print the number of blocks of every file\n");
+}
+
+template<class T, class ... Args>
+silo_pass::analysis_factory factory(Args ... args) {
+	return [args...]() {
+		return std::unique_ptr<silo_pass::analysis>(new T(args...));
+	};
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	int threads = std::thread::hardware_concurrency();
+	bool counts = false;
+	silo_pass::runner runner;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg.compare(0, 10, "--threads=") == 0) {
+			threads = std::stoi(arg.substr(10));
+		} else if (arg == "--planes") {
+			runner.add(factory<silo_pass::plane_analysis>());
+		} else if (arg == "--dredge") {
+			runner.add(factory<silo_pass::dredge_analysis>());
+		} else if (arg == "--omega") {
+			runner.add(factory<silo_pass::omega_profile_analysis>(std::string()));
+		} else if (arg == "--species") {
+			runner.add(factory<silo_pass::species_mass_analysis>());
+		} else if (arg == "--counts") {
+			counts = true;
+		} else if (arg.compare(0, 2, "--") == 0) {
+			usage();
+			return -1;
+		} else {
+			files.push_back(arg);
+		}
+	}
+	if (files.empty()) {
+		usage();
+		return -1;
+	}
+
+	const auto results = runner.run(files, threads);
+	int failed = 0;
+	for (const auto &r : results) {
+		if (!r.ok) {
+			printf("%s could not be read\n", r.info.filename.c_str());
+			++failed;
+		} else if (counts) {
+			printf("%s has %li blocks\n", r.info.filename.c_str(), long(r.info.block_count));
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -3,10 +3,12 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-#include <silo.h>
+#include "silo_pass.hpp"
 
 #include <cstdio>
 #include <string>
+#include <thread>
+#include <vector>
 
 int main(int argc, char* argv[])
 {
@@ -19,23 +21,28 @@ int main(int argc, char* argv[])
     int maxblocks = 0;
     int count = std::stoi(argv[2]);
     char* prefix = argv[1];
+    std::vector<std::string> names;
     for (int i = 0; i < count; i++)
     {
-        std::string const name =
-            std::string(prefix) + "." + std::to_string(i) + ".silo";
-        auto db = DBOpenReal(name.c_str(), DB_HDF5, DB_READ);
-        if (db)
+        names.push_back(
+            std::string(prefix) + "." + std::to_string(i) + ".silo");
+    }
+    /* without analyses the runner only reads the multimeshes */
+    silo_pass::runner runner;
+    const auto results =
+        runner.run(names, std::thread::hardware_concurrency());
+    for (int i = 0; i < count; i++)
+    {
+        if (results[i].ok)
         {
-            auto mesh = DBGetMultimesh(db, "quadmesh");
-            if (maxblocks < mesh->nblocks)
+            const int nblocks = results[i].info.block_count;
+            if (maxblocks < nblocks)
             {
                 maxblockindex = i;
-                maxblocks = mesh->nblocks;
+                maxblocks = nblocks;
             }
-            printf("%i has %i blocks current max is %i\n", i,
-                int(mesh->nblocks), maxblocks);
-            DBFreeMultimesh(mesh);
-            DBClose(db);
+            printf("%i has %i blocks current max is %i\n", i, nblocks,
+                maxblocks);
         }
         else
         {
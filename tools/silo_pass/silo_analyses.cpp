@@ -0,0 +1,235 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "silo_analyses.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+#define SILO_DRIVER DB_HDF5
+
+namespace silo_pass {
+
+namespace {
+
+constexpr double ZERO = 1e-10;
+
+std::vector<std::string> species_fields(const file_info &info) {
+	std::vector<std::string> names;
+	for (long long s = 1; s <= info.n_species; ++s) {
+		names.push_back("rho_" + std::to_string(s));
+	}
+	return names;
+}
+
+std::vector<char*> c_strings(std::vector<std::string> &strings) {
+	std::vector<char*> ptrs;
+	for (auto &s : strings) {
+		ptrs.push_back(&s[0]);
+	}
+	return ptrs;
+}
+
+}
+
+std::vector<std::string> plane_analysis::fields(const file_info&) const {
+	return {"*"};
+}
+
+void plane_analysis::begin_file(const file_info &info) {
+	const auto slash = info.filename.find_last_of('/') + 1;
+	const auto out_filename = info.filename.substr(0, slash) + "plane." + info.filename.substr(slash);
+	db_out.reset(DBCreateReal(out_filename.c_str(), DB_CLOBBER, DB_LOCAL, "Octo-tiger", SILO_DRIVER));
+	if (db_out == nullptr) {
+		throw std::runtime_error("unable to create " + out_filename);
+	}
+	var_names = info.var_names;
+	var_paths.assign(var_names.size(), { });
+	const auto *toc = DBGetToc(info.db);
+	const std::vector<std::string> scalars(toc->var_names, toc->var_names + toc->nvar);
+	for (const auto &name : scalars) {
+		int len = DBGetVarLength(info.db, name.c_str());
+		const auto vlen = DBGetVarByteLength(info.db, name.c_str());
+		const auto type = DBGetVarType(info.db, name.c_str());
+		std::vector<char> data(vlen);
+		DBReadVar(info.db, name.c_str(), data.data());
+		DBWrite(db_out.get(), name.c_str(), data.data(), &len, 1, type);
+	}
+}
+
+void plane_analysis::process(const file_info&, const block &blk) {
+	const auto &zc = blk.x[2];
+	int l_plane = -1;
+	for (int l = 0; l < blk.dims[2]; l++) {
+		if (zc[l] < ZERO && zc[l] + 0.5 * blk.dx >= ZERO) {
+			l_plane = l;
+			break;
+		}
+	}
+	if (l_plane == -1) {
+		return;
+	}
+	const auto layer = std::size_t(blk.dims[0]) * blk.dims[1];
+	std::vector<double> plane(layer);
+	auto lock = lock_silo();
+	DBMkDir(db_out.get(), blk.name.c_str());
+	DBSetDir(db_out.get(), blk.name.c_str());
+	int one = 1;
+	auto optlist_var = DBMakeOptlist(1);
+	DBAddOption(optlist_var, DBOPT_HIDE_FROM_GUI, &one);
+	auto *mesh = const_cast<DBquadmesh*>(blk.mesh);
+	DBPutQuadmesh(db_out.get(), "quadmesh_2d", mesh->labels, mesh->coords, mesh->dims, 2, mesh->datatype, mesh->coordtype, optlist_var);
+	mesh_paths.push_back(blk.name + "/quadmesh_2d");
+	int dims[2] = { blk.dims[0], blk.dims[1] };
+	for (std::size_t f = 0; f < var_names.size(); ++f) {
+		const auto &values = blk.field(var_names[f]);
+		std::copy(values.begin() + l_plane * layer, values.begin() + (l_plane + 1) * layer, plane.begin());
+		DBPutQuadvar1(db_out.get(), var_names[f].c_str(), "quadmesh_2d", plane.data(), dims, 2, nullptr, 0, DB_DOUBLE, DB_ZONECENT, optlist_var);
+		var_paths[f].push_back(blk.name + "/" + var_names[f]);
+	}
+	DBFreeOptlist(optlist_var);
+	DBSetDir(db_out.get(), "..");
+}
+
+void plane_analysis::end_file(const file_info &info) {
+	const int n_total_domains = mesh_paths.size();
+	int mesh_type = DB_QUADMESH;
+	auto optlist_var = DBMakeOptlist(1);
+	DBAddOption(optlist_var, DBOPT_MB_BLOCK_TYPE, &mesh_type);
+	auto mesh_ptrs = c_strings(mesh_paths);
+	DBPutMultimesh(db_out.get(), "quadmesh_2d", n_total_domains, mesh_ptrs.data(), nullptr, optlist_var);
+	DBFreeOptlist(optlist_var);
+	for (std::size_t f = 0; f < var_names.size(); ++f) {
+		auto var_ptrs = c_strings(var_paths[f]);
+		DBPutMultivar(db_out.get(), var_names[f].c_str(), n_total_domains, var_ptrs.data(), std::vector<int>(n_total_domains, DB_QUADVAR).data(), nullptr);
+	}
+	if (DBInqVarExists(info.db, "expressions")) {
+		auto tmp = DBGetDefvars(info.db, "expressions");
+		DBPutDefvars(db_out.get(), "expressions", tmp->ndefs, tmp->names, tmp->types, tmp->defns, nullptr);
+		DBFreeDefvars(tmp);
+	}
+	db_out.reset();
+}
+
+std::vector<std::string> dredge_analysis::fields(const file_info&) const {
+	return {"rho_1"};
+}
+
+void dredge_analysis::process(const file_info&, const block &blk) {
+	const auto dV = blk.volume();
+	const auto rho1_max1 = std::pow(10.0, 5.0);
+	const auto rho1_max2 = std::pow(10.0, 5.2);
+	for (const auto rho1 : blk.field("rho_1")) {
+		if (rho1 < rho1_max1) {
+			sum1 += dV * rho1;
+		}
+		if (rho1 < rho1_max2) {
+			sum2 += dV * rho1;
+		}
+	}
+}
+
+void dredge_analysis::report(const file_info &info) {
+	const auto Msol = 1.989e+33;
+	FILE *fp = fopen("dredge.dat", "at");
+	fprintf(fp, "%e %e %e\n", info.time, sum1 / Msol, sum2 / Msol);
+	fclose(fp);
+}
+
+std::vector<std::string> omega_profile_analysis::fields(const file_info &info) const {
+	auto names = species_fields(info);
+	names.push_back("sx");
+	names.push_back("sy");
+	return names;
+}
+
+void omega_profile_analysis::begin_file(const file_info &info) {
+	const double rmax = 1.5;
+	const int NBIN = rmax / info.dx_min;
+	dR = rmax / NBIN;
+	Ibin.assign(NBIN, 0.0);
+	Lbin.assign(NBIN, 0.0);
+}
+
+void omega_profile_analysis::process(const file_info &info, const block &blk) {
+	const auto species = species_fields(info);
+	std::vector<const double*> rho_s;
+	for (const auto &s : species) {
+		rho_s.push_back(blk.field(s).data());
+	}
+	const auto *sx = blk.field("sx").data();
+	const auto *sy = blk.field("sy").data();
+	const auto dV = blk.volume();
+	const int NBIN = Ibin.size();
+	for (int k = 0; k < blk.dims[2]; k++) {
+		for (int j = 0; j < blk.dims[1]; j++) {
+			for (int i = 0; i < blk.dims[0]; i++) {
+				const auto iii = (k * blk.dims[1] + j) * blk.dims[0] + i;
+				double rho = 0.0;
+				for (const auto *r : rho_s) {
+					rho += r[iii];
+				}
+				const auto vx = sx[iii] / rho;
+				const auto vy = sy[iii] / rho;
+				const auto x = (blk.x[0][i] + blk.x[0][i + 1]) / 2.0;
+				const auto y = (blk.x[1][j] + blk.x[1][j + 1]) / 2.0;
+				const auto R = std::sqrt(x * x + y * y);
+				const auto omega = (-y * vx + x * vy) / (R * R);
+				const int I = R / dR;
+				if (I < NBIN) {
+					Lbin[I] += rho * R * R * omega * dV;
+					Ibin[I] += rho * R * R * dV;
+				}
+			}
+		}
+	}
+}
+
+void omega_profile_analysis::report(const file_info &info) {
+	auto name = filename;
+	if (name.empty()) {
+		const auto base = info.filename.substr(info.filename.find_last_of('/') + 1);
+		name = "omega." + base.substr(0, base.rfind(".silo")) + ".dat";
+	}
+	FILE *fp = fopen(name.c_str(), "wt");
+	for (std::size_t i = 0; i < Ibin.size(); i++) {
+		fprintf(fp, "%e %e\n", (i + 0.5) * dR, Lbin[i] / Ibin[i]);
+	}
+	fclose(fp);
+}
+
+std::vector<std::string> species_mass_analysis::fields(const file_info &info) const {
+	return species_fields(info);
+}
+
+void species_mass_analysis::begin_file(const file_info &info) {
+	mass.assign(info.n_species, 0.0);
+}
+
+void species_mass_analysis::process(const file_info &info, const block &blk) {
+	const auto species = species_fields(info);
+	const auto dV = blk.volume();
+	for (std::size_t s = 0; s < species.size(); ++s) {
+		double sum = 0.0;
+		for (const auto rho : blk.field(species[s])) {
+			sum += rho;
+		}
+		mass[s] += sum * dV;
+	}
+}
+
+void species_mass_analysis::report(const file_info &info) {
+	FILE *fp = fopen("species.dat", "at");
+	fprintf(fp, "%e", info.time);
+	for (const auto m : mass) {
+		fprintf(fp, " %e", m);
+	}
+	fprintf(fp, "\n");
+	fclose(fp);
+}
+
+}
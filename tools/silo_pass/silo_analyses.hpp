@@ -0,0 +1,74 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "silo_pass.hpp"
+
+#include <string>
+#include <vector>
+
+/* The analyses of silo_post, silo_planes and silo_analyze */
+namespace silo_pass {
+
+/* Extracts the z = 0 plane into a 2D Silo file, plane.<input file name> next to the input */
+class plane_analysis: public analysis {
+public:
+	std::vector<std::string> fields(const file_info&) const override;
+	void begin_file(const file_info&) override;
+	void process(const file_info&, const block&) override;
+	void end_file(const file_info&) override;
+
+private:
+	db_ptr db_out;
+	std::vector<std::string> var_names;
+	std::vector<std::string> mesh_paths;
+	std::vector<std::vector<std::string>> var_paths;
+};
+
+/* Mass of species 1 below the densities 1e5 and 10^5.2, appended to dredge.dat in solar masses */
+class dredge_analysis: public analysis {
+public:
+	std::vector<std::string> fields(const file_info&) const override;
+	void process(const file_info&, const block&) override;
+	void report(const file_info&) override;
+
+private:
+	double sum1 = 0.0;
+	double sum2 = 0.0;
+};
+
+/* Specific angular frequency about the z axis, binned in cylindrical radius at the finest resolution.
+ * Written to filename, or to omega.<input file name without .silo>.dat when it is empty. */
+class omega_profile_analysis: public analysis {
+public:
+	omega_profile_analysis(std::string filename) :
+			filename(std::move(filename)) {
+	}
+	std::vector<std::string> fields(const file_info&) const override;
+	void begin_file(const file_info&) override;
+	void process(const file_info&, const block&) override;
+	void report(const file_info&) override;
+
+private:
+	std::string filename;
+	double dR = 0.0;
+	std::vector<double> Ibin;
+	std::vector<double> Lbin;
+};
+
+/* Total mass of every species, appended to species.dat as time M_1 ... M_n */
+class species_mass_analysis: public analysis {
+public:
+	std::vector<std::string> fields(const file_info&) const override;
+	void begin_file(const file_info&) override;
+	void process(const file_info&, const block&) override;
+	void report(const file_info&) override;
+
+private:
+	std::vector<double> mass;
+};
+
+}
@@ -0,0 +1,302 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "silo_pass.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#define SILO_DRIVER DB_HDF5
+
+namespace silo_pass {
+
+namespace {
+
+std::mutex silo_mtx;
+
+struct quadmesh_freer {
+	void operator()(DBquadmesh *mesh) const {
+		DBFreeQuadmesh(mesh);
+	}
+};
+
+struct quadvar_freer {
+	void operator()(DBquadvar *var) const {
+		DBFreeQuadvar(var);
+	}
+};
+
+/* must be released with the Silo lock held, like db_ptr */
+using quadmesh_ptr = std::unique_ptr<DBquadmesh, quadmesh_freer>;
+using quadvar_ptr = std::unique_ptr<DBquadvar, quadvar_freer>;
+
+struct block_location {
+	std::string name;
+	std::string file;
+	std::string dir;
+};
+
+std::string directory_of(const std::string &path) {
+	const auto pos = path.find_last_of('/');
+	return pos == std::string::npos ? std::string() : path.substr(0, pos + 1);
+}
+
+template<class T>
+T read_scalar(DBfile *db, const char *name, T def) {
+	T value = def;
+	if (DBInqVarExists(db, name)) {
+		DBReadVar(db, name, &value);
+	}
+	return value;
+}
+
+std::vector<double> read_array(DBfile *db, const char *name, std::size_t n) {
+	std::vector<double> values;
+	if (DBInqVarExists(db, name) && n > 0) {
+		values.resize(n);
+		DBReadVar(db, name, values.data());
+	}
+	return values;
+}
+
+template<class T>
+void copy_values(const void *src, int datatype, std::size_t n, std::vector<T> &dest) {
+	dest.resize(n);
+	if (datatype == DB_FLOAT) {
+		const auto *p = static_cast<const float*>(src);
+		std::copy(p, p + n, dest.begin());
+	} else {
+		const auto *p = static_cast<const double*>(src);
+		std::copy(p, p + n, dest.begin());
+	}
+}
+
+/* Blocks of a master file through its multimesh, data files are relative to the master.  For a single data file the
+ * blocks are its top level directories holding a quadmesh. */
+std::vector<block_location> find_blocks(DBfile *db, const std::string &filename) {
+	std::vector<block_location> blocks;
+	if (DBInqVarExists(db, "quadmesh")) {
+		auto *mesh = DBGetMultimesh(db, "quadmesh");
+		const auto base = directory_of(filename);
+		for (int i = 0; i < mesh->nblocks; ++i) {
+			const std::string mesh_name = mesh->meshnames[i];
+			const auto colon = mesh_name.find(':');
+			block_location loc;
+			std::string path;
+			if (colon == std::string::npos) {
+				loc.file = filename;
+				path = mesh_name;
+			} else {
+				loc.file = base + mesh_name.substr(0, colon);
+				path = mesh_name.substr(colon + 1);
+			}
+			loc.dir = path.substr(0, path.find_last_of('/'));
+			loc.name = loc.dir.substr(loc.dir.find_last_of('/') + 1);
+			blocks.push_back(std::move(loc));
+		}
+		DBFreeMultimesh(mesh);
+	} else {
+		const auto *toc = DBGetToc(db);
+		const std::vector<std::string> dirs(toc->dir_names, toc->dir_names + toc->ndir);
+		for (const auto &dir : dirs) {
+			if (DBInqVarExists(db, ("/" + dir + "/quadmesh").c_str())) {
+				blocks.push_back(block_location { dir, filename, "/" + dir });
+			}
+		}
+	}
+	return blocks;
+}
+
+}
+
+std::unique_lock<std::mutex> lock_silo() {
+	return std::unique_lock<std::mutex>(silo_mtx);
+}
+
+const std::vector<double>& block::field(const std::string &name) const {
+	const auto it = fields.find(name);
+	if (it == fields.end()) {
+		throw std::runtime_error("field " + name + " was not read for block " + this->name);
+	}
+	return it->second;
+}
+
+void runner::add(analysis_factory f) {
+	factories_.push_back(std::move(f));
+}
+
+std::vector<file_result> runner::run(const std::vector<std::string> &files, int threads) {
+	std::vector<file_result> results(files.size());
+	for (std::size_t i = 0; i < files.size(); ++i) {
+		results[i].info.filename = files[i];
+	}
+	std::atomic<std::size_t> next(0);
+	const auto work = [this, &results, &next]() {
+		for (std::size_t i = next++; i < results.size(); i = next++) {
+			try {
+				run_file(results[i]);
+			} catch (const std::exception &e) {
+				fprintf(stderr, "%s: %s\n", results[i].info.filename.c_str(), e.what());
+				results[i].ok = false;
+				/* never reported, and they may still hold Silo handles */
+				auto lock = lock_silo();
+				results[i].analyses.clear();
+			}
+		}
+	};
+	const int nthreads = std::max(1, std::min<int>(threads, files.size()));
+	std::vector<std::thread> workers;
+	for (int t = 1; t < nthreads; ++t) {
+		workers.emplace_back(work);
+	}
+	work();
+	for (auto &w : workers) {
+		w.join();
+	}
+	for (auto &r : results) {
+		if (r.ok) {
+			for (auto &a : r.analyses) {
+				a->report(r.info);
+			}
+		}
+	}
+	return results;
+}
+
+void runner::run_file(file_result &result) const {
+	auto &info = result.info;
+	/* the lock outlives the Silo handles below, so they are always released while holding it */
+	auto lock = lock_silo();
+	std::map<std::string, db_ptr> files;
+	std::vector<block_location> locations;
+	std::vector<quadmesh_ptr> meshes;
+	std::vector<std::string> names;
+
+	db_ptr master(DBOpenReal(info.filename.c_str(), SILO_DRIVER, DB_READ));
+	if (master == nullptr) {
+		return;
+	}
+	info.db = master.get();
+	files[info.filename] = std::move(master);
+	const auto open = [&files](const std::string &name) {
+		auto &db = files[name];
+		if (db == nullptr) {
+			db.reset(DBOpenReal(name.c_str(), SILO_DRIVER, DB_READ));
+			if (db == nullptr) {
+				throw std::runtime_error("unable to open " + name);
+			}
+		}
+		return db.get();
+	};
+	info.cgs_time = read_scalar<double>(info.db, "cgs_time", 0.0);
+	info.omega = read_scalar<double>(info.db, "omega", 0.0);
+	info.version = read_scalar<long long>(info.db, "version", 0);
+	info.n_species = read_scalar<long long>(info.db, "n_species", 0);
+	info.atomic_mass = read_array(info.db, "atomic_mass", info.n_species);
+	info.atomic_number = read_array(info.db, "atomic_number", info.n_species);
+
+	locations = find_blocks(info.db, info.filename);
+	info.block_count = locations.size();
+	if (factories_.empty()) {
+		info.db = nullptr;
+		result.ok = true;
+		return;
+	}
+	/* the meshes are small, read them all up front so dx_min is known before the first block */
+	info.dx_min = std::numeric_limits<double>::max();
+	for (const auto &loc : locations) {
+		quadmesh_ptr mesh(DBGetQuadmesh(open(loc.file), (loc.dir + "/quadmesh").c_str()));
+		if (mesh == nullptr) {
+			throw std::runtime_error("unable to read the mesh of block " + loc.name);
+		}
+		std::vector<double> x0;
+		copy_values(mesh->coords[0], mesh->datatype, 2, x0);
+		info.dx_min = std::min(info.dx_min, x0[1] - x0[0]);
+		meshes.push_back(std::move(mesh));
+	}
+	if (!meshes.empty()) {
+		info.time = meshes.front()->dtime;
+	}
+
+	const auto *toc = DBGetToc(info.db);
+	if (toc->nmultivar > 0) {
+		info.var_names.assign(toc->multivar_names, toc->multivar_names + toc->nmultivar);
+	} else if (!locations.empty()) {
+		auto *db = open(locations.front().file);
+		DBSetDir(db, locations.front().dir.c_str());
+		toc = DBGetToc(db);
+		info.var_names.assign(toc->qvar_names, toc->qvar_names + toc->nqvar);
+		DBSetDir(db, "/");
+	}
+
+	for (const auto &f : factories_) {
+		result.analyses.push_back(f());
+	}
+	std::set<std::string> needed;
+	for (const auto &a : result.analyses) {
+		for (const auto &name : a->fields(info)) {
+			if (name == "*") {
+				needed.insert(info.var_names.begin(), info.var_names.end());
+			} else {
+				needed.insert(name);
+			}
+		}
+	}
+	names.assign(needed.begin(), needed.end());
+	for (auto &a : result.analyses) {
+		a->begin_file(info);
+	}
+
+	for (std::size_t b = 0; b != locations.size(); ++b) {
+		const auto &loc = locations[b];
+		const auto *mesh = meshes[b].get();
+		block blk;
+		blk.name = loc.name;
+		blk.mesh = mesh;
+		for (int d = 0; d < 3; ++d) {
+			const int n = d < mesh->ndims ? mesh->dims[d] : 2;
+			if (d < mesh->ndims) {
+				copy_values(mesh->coords[d], mesh->datatype, n, blk.x[d]);
+			} else {
+				blk.x[d] = {0.0, 0.0};
+			}
+			blk.dims[d] = n - 1;
+		}
+		blk.dx = blk.x[0][1] - blk.x[0][0];
+		auto *db = open(loc.file);
+		for (const auto &name : names) {
+			quadvar_ptr var(DBGetQuadvar(db, (loc.dir + "/" + name).c_str()));
+			if (var != nullptr) {
+				copy_values(var->vals[0], var->datatype, var->nels, blk.fields[name]);
+			}
+		}
+		lock.unlock();
+		try {
+			for (auto &a : result.analyses) {
+				a->process(info, blk);
+			}
+		} catch (...) {
+			lock.lock();
+			throw;
+		}
+		lock.lock();
+	}
+
+	for (auto &a : result.analyses) {
+		a->end_file(info);
+	}
+	meshes.clear();
+	files.clear();
+	info.db = nullptr;
+	result.ok = true;
+}
+
+}
@@ -0,0 +1,120 @@
+//  Copyright (c) 2019 AUTHORS
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <silo.h>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Single pass post-processing of Octo-tiger Silo output.
+ *
+ * A runner reads every file exactly once: the meshes of all blocks first, then block by block the union
+ * of the quadvars its analyses asked for.  Each block is handed to every registered analysis before the
+ * next one is read.  Files are processed concurrently, one file per thread, with a fresh set of analyses
+ * per file, so analyses never see two threads.  Their per file results are reported after all files are
+ * done, in the order the files were given.
+ *
+ * Silo and HDF5 are not thread safe.  The runner holds the Silo lock while calling begin_file and
+ * end_file, process is called without it and must take it (lock_silo) around any Silo call.  When a file
+ * fails its analyses are destroyed under the lock, so they may keep Silo handles in a db_ptr.
+ */
+namespace silo_pass {
+
+std::unique_lock<std::mutex> lock_silo();
+
+struct db_closer {
+	void operator()(DBfile *db) const {
+		DBClose(db);
+	}
+};
+
+/* must be released with the Silo lock held */
+using db_ptr = std::unique_ptr<DBfile, db_closer>;
+
+struct file_info {
+	std::string filename;
+	/* the master (or single) file, only valid inside begin_file / end_file */
+	DBfile *db = nullptr;
+	double time = 0.0;
+	double cgs_time = 0.0;
+	double omega = 0.0;
+	long long version = 0;
+	long long n_species = 0;
+	std::vector<double> atomic_mass;
+	std::vector<double> atomic_number;
+	/* the quadvars of the file, from its multivars or from the first block */
+	std::vector<std::string> var_names;
+	std::size_t block_count = 0;
+	double dx_min = 0.0;
+};
+
+struct block {
+	/* directory of the block, the node location */
+	std::string name;
+	/* only valid inside process, must not be freed */
+	const DBquadmesh *mesh;
+	/* cell edges in every dimension */
+	std::array<std::vector<double>, 3> x;
+	/* cells in every dimension */
+	std::array<int, 3> dims;
+	double dx;
+	/* the requested quadvars, converted to double, in Silo (x fastest) order */
+	std::map<std::string, std::vector<double>> fields;
+
+	const std::vector<double>& field(const std::string &name) const;
+	std::size_t size() const {
+		return std::size_t(dims[0]) * dims[1] * dims[2];
+	}
+	double volume() const {
+		return dx * dx * dx;
+	}
+};
+
+class analysis {
+public:
+	virtual ~analysis() = default;
+	/* quadvars needed in process, "*" stands for all of them */
+	virtual std::vector<std::string> fields(const file_info&) const {
+		return {};
+	}
+	virtual void begin_file(const file_info&) {
+	}
+	virtual void process(const file_info&, const block&) = 0;
+	virtual void end_file(const file_info&) {
+	}
+	/* once all files are done, the Silo files are closed by then */
+	virtual void report(const file_info&) {
+	}
+};
+
+using analysis_factory = std::function<std::unique_ptr<analysis>()>;
+
+struct file_result {
+	file_info info;
+	/* false when the file could not be opened, the analyses have not been called */
+	bool ok = false;
+	/* one per registered factory, in registration order */
+	std::vector<std::unique_ptr<analysis>> analyses;
+};
+
+class runner {
+public:
+	void add(analysis_factory);
+	std::vector<file_result> run(const std::vector<std::string> &files, int threads);
+
+private:
+	void run_file(file_result&) const;
+
+	std::vector<analysis_factory> factories_;
+};
+
+}